@@ -1,75 +1,251 @@
-# include "6502v2.h"
+# include "dispatch.h"
+# include "console.h"
+# include "batch.h"
+# include "fuzz.h"
+# include <cctype>
+# include <cerrno>
+# include <cstdio>
+# include <cstdlib>
 # include <iostream>
+# include <stdexcept>
 # include <string>
 
 
 
 Dodgy6502::Dodgy6502(){
-    add_all_instructions();
-    memory = new byte[64*1024]; // 64KB RAM, 16 bit address space
+    memory = new byte[2*256](); // zero page and stack, the rest of the RAM is allocated on demand
+    ram_pages[0] = memory;
+    ram_pages[1] = memory + 256;
+    map_ram(0, 256);
     reset();
-
-    try{
-        run();
-
-    } catch(std::exception& e)
-    {
-        std::cerr << "Caught exception:\n\t " << e.what() << std::endl;
-        std::cout << "Caught exception: " << e.what() << std::endl;
-        std::cin.get();
-        raise;
-    }
 }
 
 Dodgy6502::~Dodgy6502(){
+    flush_code();
+    for(int page = 2; page < 256; page++)
+        delete[] ram_pages[page];
     delete[] memory;
 }
 
 void Dodgy6502::reset() {
     a = x = y = 0;
     sp = 0xfd;
-    sb = 0;
+    set_status(0);
     pc = 0;//0xfffc;
 }
 
-void Dodgy6502::set_flag(FLAGS6502 flag, bool v){
-    if(v) sb |= flag; else sb &= ~flag;
+void Dodgy6502::read_word(word address){
+    fetched = read(address) | (read(address+1) << 8);
+}
+void Dodgy6502::read_word(byte low, byte high){
+    fetched = read(low | (high << 8));
 }
 
-bool Dodgy6502::read_flag(FLAGS6502 flag) const{
-    return sb & flag;
+void Dodgy6502::invalidate_code(word address){
+    invalidate_decoded(address);
+    invalidate_blocks(address >> 8);
+    invalidate_jit(address >> 8);
 }
 
-void Dodgy6502::read_word(word address){
-    fetched = memory[address] | (memory[address+1] << 8);
+void Dodgy6502::flush_code(){
+    flush_decoded();
+    flush_blocks();
+    flush_jit();
+    for(auto &page : code_pages)
+        page = false;
 }
-void Dodgy6502::read_word(byte low, byte high){
-    fetched = memory[low | (high << 8)];
+
+void Dodgy6502::irq(bool asserted, unsigned int source){
+    if(asserted){
+        interrupts |= source & ~NMI_PENDING;
+        irq_unmasked();
+    }
+    else
+        interrupts &= ~source | NMI_PENDING;
 }
 
-void Dodgy6502::push(byte data){
-    memory[STACK_BASE + sp--] = data;
+void Dodgy6502::nmi(){
+    interrupts |= NMI_PENDING;
+    deadline = 0;
 }
 
-byte Dodgy6502::pop(){
-    return memory[STACK_BASE + ++sp];
+// an NMI first, it sets I so a held IRQ follows once the handler returns
+void Dodgy6502::take_interrupts(){
+    if(interrupts & NMI_PENDING){
+        interrupts &= ~NMI_PENDING;
+        interrupt(0xfffa);
+    }
+    else if(interrupts && !(sb & I))
+        interrupt(0xfffe);
 }
 
-void Dodgy6502::irq(){}
-void Dodgy6502::nmi(){}
+void Dodgy6502::interrupt(word vector){
+    push(pc >> 8);
+    push(pc);
+    push((status() & ~B) | COMPLETE);
+    sb |= I;
+    pc = read(vector) | (read(vector + 1) << 8);
+    cycles += 7;
+}
 
-void Dodgy6502::run(){
-    while(true){
-        current_instruction = &instructions[memory[pc++]];
-        (this->*current_instruction->addr_mode)();
-        (this->*current_instruction->implementation)();
+Dodgy6502::STOPS6502 Dodgy6502::run(){
+    return run_engine(~0ull, NO_STOP_PC);
+}
+
+Dodgy6502::STOPS6502 Dodgy6502::run_for(unsigned long long budget){
+    return run_engine(budget, NO_STOP_PC);
+}
+
+Dodgy6502::STOPS6502 Dodgy6502::run_until(word address, unsigned long long budget){
+    return run_engine(budget, address);
+}
+
+Dodgy6502::STOPS6502 Dodgy6502::step(){
+    if(interrupts)
+        take_interrupts();
+    byte opcode = read(pc++);
+    byte taken = execute_opcode(*this, opcode);
+    if(!taken)
+        return stop_reason(opcode);
+    cycles += taken;
+    if(!events.empty() && events.front().at <= cycles)
+        dispatch_events();
+    return STOP_NONE;
+}
+
+// the engine runs up to the next device event, without events that is the whole budget.
+// Interrupts are taken in front of every engine call.
+Dodgy6502::STOPS6502 Dodgy6502::run_engine(unsigned long long budget, unsigned int until){
+    unsigned long long end = budget > ~0ull - cycles ? ~0ull : cycles + budget;
+    for(;;){
+        if(interrupts)
+            take_interrupts();
+        deadline = events.empty() || events.front().at > end ? end : events.front().at;
+        STOPS6502 stop;
+        switch(engine){
+            case ENGINE_SWITCH: stop = run_switch(until); break;
+            case ENGINE_THREADED: stop = run_threaded(until); break;
+            case ENGINE_CACHED: stop = run_cached(until); break;
+            case ENGINE_BLOCKS: stop = run_blocks(until); break;
+            case ENGINE_JIT: stop = run_jit(until); break;
+            default: stop = run_reference(until);
+        }
+        if(!events.empty() && events.front().at <= cycles)
+            dispatch_events();
+        if(stop != STOP_CYCLES || cycles >= end)
+            return stop;
     }
 }
 
-int main(int argc, char* argv[]){
-    Dodgy6502 cpu;
-    byte rom[] = {0x18, 0x69, 0x01, 0, 0, 0, 0};
-    cpu.load_memory(&rom[0], 6, 0);
-    cpu.run();
+Dodgy6502::STOPS6502 Dodgy6502::run_reference(unsigned int until){
+    while(cycles < deadline){
+        if(pc == until)
+            return STOP_PC;
+        current_instruction = &instructions[read(pc++)];
+        byte crossed = (this->*current_instruction->addr_mode)();
+        if(loads_operand(current_instruction->addr_mode, current_instruction->implementation))
+            fetched = read(abs_addr);
+        byte extra = (this->*current_instruction->implementation)();
+        if(halt){
+            STOPS6502 stop = halt;
+            halt = STOP_NONE;
+            return stop;
+        }
+        if(current_instruction->addr_mode != &Dodgy6502::rel)
+            extra &= crossed; // only a page crossing adds cycles outside the branches
+        cycles += current_instruction->cycles + extra;
+    }
+    return STOP_CYCLES;
+}
+
+unsigned long long parse_number(const char* text, int base, unsigned long long max){
+    char* end;
+    errno = 0;
+    unsigned long long value = strtoull(text, &end, base);
+    if(!isxdigit((unsigned char)*text) || *end || errno || value > max)
+        throw std::invalid_argument(text);
+    return value;
+}
+
+#ifndef DODGY6502_NO_MAIN // the libFuzzer and test builds bring their own main()
+// runs one job per patch on every core and prints a line per job:
+// job, stop reason, cycles, pc, a, x, y, sp, p
+static int run_batch(int argc, char* argv[]){
+    BatchJob job;
+    job.rom_base = parse_number(argv[3], 16, 0xffff);
+    job.pc = parse_number(argv[4], 16, 0xffff);
+    job.budget = parse_number(argv[5], 10, ~0ull);
+    std::vector<BatchJob> jobs;
+    for(int i = 6; i < argc; i++){
+        std::string patch = argv[i];
+        size_t colon = patch.find(':');
+        if(colon == std::string::npos || (patch.size() - colon) % 2 == 0)
+            throw std::invalid_argument(patch);
+        MemoryPatch bytes;
+        bytes.address = parse_number(patch.substr(0, colon).c_str(), 16, 0xffff);
+        for(size_t digit = colon + 1; digit < patch.size(); digit += 2)
+            bytes.data.push_back(parse_number(patch.substr(digit, 2).c_str(), 16, 0xff));
+        if(bytes.data.size() > 0x10000u - bytes.address)
+            throw std::invalid_argument(patch);
+        jobs.push_back(job);
+        jobs.back().patches.push_back(bytes);
+    }
+    const RomFile &rom = RomFile::shared(argv[2]);
+    for(BatchJob &each : jobs)
+        each.rom = &rom;
+    std::vector<BatchResult> results = BatchRunner().run(jobs);
+    for(size_t i = 0; i < results.size(); i++){
+        const BatchResult &r = results[i];
+        printf("%zu %d %llu %04x %02x %02x %02x %02x %02x\n", i, r.stop, r.cycles, r.pc, r.a, r.x, r.y, r.sp, r.p);
+    }
     return 0;
-}
\ No newline at end of file
+}
+
+static const char* const USAGE =
+    "usage: Dodgy6502 [image [load address [start address]]]\n"
+    "       Dodgy6502 --batch image load start budget address:hexbytes...\n"
+    "       Dodgy6502 --fuzz image load start budget input [file]\n"
+    "addresses and bytes in hex, budgets in cycles, input is console or address[:size]\n";
+
+// usage: Dodgy6502 [image [load address [start address]]], addresses in hex. An image
+// runs until it halts, with a Console on stdin and stdout mapped at $F000.
+//        Dodgy6502 --batch image load start budget address:hexbytes...
+// runs the image once per patch, see run_batch().
+//        Dodgy6502 --fuzz image load start budget input [file]
+// runs the input from the file or stdin for AFL, see fuzz_setup() for `input`.
+// Malformed arguments print the usage, an image that cannot be loaded an error.
+int main(int argc, char* argv[]){
+    std::string mode = argc > 1 ? argv[1] : "";
+    try{
+        if(mode == "--batch" && argc > 5)
+            return run_batch(argc, argv);
+        if(mode == "--fuzz" && argc > 6 && argc < 9)
+            return fuzz_afl(fuzz_setup(argv + 2, afl_map()), argc > 7 ? argv[7] : nullptr);
+        if(mode.compare(0, 2, "--") == 0 || argc > 4)
+            throw std::invalid_argument(mode);
+        word base = argc > 2 ? parse_number(argv[2], 16, 0xffff) : 0;
+        word start = argc > 3 ? parse_number(argv[3], 16, 0xffff) : base;
+        Dodgy6502 cpu;
+        if(argc > 1){
+            cpu.load_rom(argv[1], base);
+            cpu.pc = start;
+            Console console;
+            cpu.map_device(0xf0, 1, &console);
+            cpu.run();
+            return 0;
+        }
+        byte rom[] = {0x18, 0x69, 0x01, 0, 0, 0, 0};
+        cpu.load_memory(&rom[0], 6, 0);
+        cpu.run();
+        return 0;
+    }
+    catch(const std::invalid_argument &){
+        fputs(USAGE, stderr);
+        return 1;
+    }
+    catch(const std::runtime_error &error){
+        fprintf(stderr, "Dodgy6502: %s\n", error.what());
+        return 1;
+    }
+}
+#endif
@@ -1,22 +1,120 @@
 #pragma once
-#include <string>
+#include <vector>
 #include <exception>
 
 #ifndef INC_6502_6502V2_H
 
 #define STACK_BASE 0x0100
+#define BLOCK_MAX_OPS 32
+#define NO_STOP_PC 0x10000 // run_until() address that pc never reaches
+
+// inline every call made by an engine loop into the loop itself
+#if defined(__GNUC__)
+#define DODGY_FLATTEN __attribute__((flatten))
+#define DODGY_NOINLINE __attribute__((noinline))
+#define DODGY_LIKELY(x) __builtin_expect(!!(x), 1)
+#else
+#define DODGY_FLATTEN
+#define DODGY_NOINLINE
+#define DODGY_LIKELY(x) (x)
+#endif
 
 typedef unsigned char byte;
 typedef unsigned short word;
 
 class Dodgy6502;
+struct JitCache;
+struct Snapshot;
+class RomFile;
+
+// an instruction decoded once by the decode cache, see decode_cache.cpp
+struct DecodedInstruction {
+    byte(*handler)(Dodgy6502 &cpu, const DecodedInstruction &instruction) = nullptr; // returns the cycles taken
+    word operand;
+    word operand2; // operand of the second instruction of a fused pair
+    byte length;
+};
 
+// straight-line code translated by the block cache, see block_cache.cpp
+struct TranslatedBlock {
+    byte count = 0;
+    DecodedInstruction ops[BLOCK_MAX_OPS];
+};
+
+// a peripheral mapped into the address space with Dodgy6502::map_device()
+class BusDevice {
+public:
+    virtual ~BusDevice() = default;
+    virtual byte read(word address) = 0;
+    virtual void write(word address, byte data) = 0;
+};
+
+// a bank switching board, see mapper.cpp. Writes to its register pages reach write(), which
+// answers them by selecting banks. Selecting swaps page table entries and drops cached code
+// of only the swapped pages, no memory is copied.
+class Mapper : public BusDevice {
+public:
+    explicit Mapper(Dodgy6502 &cpu) : cpu(cpu) {}
+    byte read(word address) override; // register pages without a bank read as 0
+protected:
+    Dodgy6502 &cpu;
+    bool trapped[256] = {};
+    void trap_writes(byte first_page, int pages); // reads keep going to the selected bank
+    void select_rom(byte first_page, int pages, const byte* bank);
+    void select_ram(byte first_page, int pages, byte* bank);
+};
+
+// a window of ROM banks, writing a bank number anywhere in the window selects that bank
+class RomBanks : public Mapper {
+public:
+    RomBanks(Dodgy6502 &cpu, byte first_page, int pages, const byte* banks, int count);
+    RomBanks(Dodgy6502 &cpu, byte first_page, int pages, const RomFile &rom, size_t offset, int count); // banks from `offset` on
+    void write(word address, byte data) override;
+    int selected() const; // read off the page table, so a restored snapshot brings it back too
+private:
+    byte first_page;
+    int pages;
+    const byte* banks;
+    int count;
+};
+
+// a device called back at the cycle it scheduled with Dodgy6502::schedule(), see scheduler.cpp
+class TimedDevice {
+public:
+    virtual ~TimedDevice() = default;
+    virtual void event(Dodgy6502 &cpu, int id) = 0; // cpu.cycles can be a few cycles past the scheduled one
+};
+
+// read only memory mapping of a ROM file, see rom.cpp. The CPUs it is loaded into point
+// straight into the mapping, so it has to outlive them.
+class RomFile {
+public:
+    explicit RomFile(const char* filename);
+    ~RomFile();
+    RomFile(const RomFile&) = delete;
+    RomFile& operator=(const RomFile&) = delete;
+    static const RomFile& shared(const char* filename); // mapped once per process, never unmapped
+    const byte* at(size_t offset, int pages) const; // `pages` whole pages from `offset`, throws past the end
+    const byte* data = nullptr;
+    size_t size = 0;
+    size_t readable = 0; // size up to the end of its system page, the rest reads as zeros
+};
+
+// all of a command line argument as a number up to `max`, throws std::invalid_argument
+// for anything else, including signs, blanks and overflow
+unsigned long long parse_number(const char* text, int base, unsigned long long max);
+
+// hot part of an opcode table entry, all run_reference() touches
 struct Instruction {
-    std::string name;
-    byte(Dodgy6502::*addr_mode)() = nullptr;
-    byte(Dodgy6502::*implementation)() = nullptr;
+    byte(Dodgy6502::*addr_mode)();
+    byte(Dodgy6502::*implementation)();
     byte cycles;
-    std::string description;
+};
+
+// cold part, only needed for disassembly and debugging
+struct InstructionInfo {
+    const char* name;
+    const char* description;
 };
 
 class Dodgy6502{
@@ -24,21 +122,124 @@ public:
     Dodgy6502();
     ~Dodgy6502();
     void reset();
-    void irq(); // maskable interrupt
-    void nmi(); // non-maskabl e interrupt
-    void load_rom(const char *filename);
-    void run();
+    void irq(bool asserted = true, unsigned int source = 1); // maskable, level triggered: held until its source releases it
+    void nmi(); // non-maskable, edge triggered: latched until taken
+    void load_rom(const char *filename, word base = 0); // shares one mapping of the file between all CPUs
+    void load_rom(const RomFile &rom, word base = 0); // copy on write, see rom.cpp
+
+    // Fork server style resets, see snapshot.cpp. restore() only copies back the pages
+    // written or remapped since the snapshot, or since the last restore of the same one.
+    void snapshot(Snapshot &saved);
+    void restore(const Snapshot &saved);
+    unsigned long long dirty_pages[4] = {}; // bit per page written or remapped since the last snapshot or restore
+    unsigned long long snapshots = 0; // taken of this CPU, numbers them
+    unsigned long long baseline = 0; // number of the snapshot dirty_pages counts from, 0 for none
+    void mark_dirty(byte page);
+
+    // why a bounded run returned
+    enum STOPS6502{
+        STOP_NONE, // step() executed its instruction
+        STOP_CYCLES, // the cycle budget is used up
+        STOP_PC, // pc reached the address passed to run_until()
+        STOP_BRK, // pc points at a BRK
+        STOP_JAM, // pc points at a JAM
+        STOP_INVALID, // pc points at an undocumented opcode
+    };
+    STOPS6502 halt = STOP_NONE; // set by the halting instructions, read by run_reference()
+
+    // Bounded runs on the engine selected by `engine`. The budget is checked in front of
+    // every instruction, or every block for the block engines, so a run can end a few
+    // cycles past it. run_until() stops before executing the instruction at `address`.
+    // Device events due on the way are dispatched between instructions.
+    STOPS6502 run(); // until a halting instruction
+    STOPS6502 run_for(unsigned long long budget);
+    STOPS6502 run_until(word address, unsigned long long budget = ~0ull);
+    STOPS6502 step(); // exactly one instruction, always on the switch core
+    STOPS6502 run_engine(unsigned long long budget, unsigned int until);
+
+    // device events, see scheduler.cpp. Runs stop at the next event instead of polling.
+    struct Event {
+        unsigned long long at;
+        TimedDevice* device;
+        int id;
+    };
+    std::vector<Event> events; // min heap on `at`
+    void schedule(unsigned long long at, TimedDevice* device, int id = 0); // replaces a pending event with the same device and id
+    void cancel(TimedDevice* device, int id = 0);
+    void dispatch_events(); // calls the devices of the events that are due
+
+    // Pending interrupts, the IRQ sources holding the line in the low bits and a latched NMI
+    // in the top bit. An interrupt that can be taken zeroes the deadline, so the engine stops
+    // at its next budget check and run_engine() takes it without the engines testing for it.
+    static const unsigned int NMI_PENDING = 0x80000000u;
+    unsigned int interrupts = 0;
+    void take_interrupts();
+    void interrupt(word vector);
+    void irq_unmasked(); // I may have been cleared
+
+    // the engines run until `cycles` reaches `deadline`, pc equals `until` or they halt
+    unsigned long long deadline = 0; // lowered by schedule() while an engine runs
+    STOPS6502 run_reference(unsigned int until); // dispatches through the instructions table
+    STOPS6502 run_switch(unsigned int until); // one inlined handler per opcode, see switch_core.cpp
+    STOPS6502 run_threaded(unsigned int until); // computed goto between handlers, see threaded_core.cpp
+    STOPS6502 run_cached(unsigned int until); // executes predecoded instructions, see decode_cache.cpp
+    STOPS6502 run_blocks(unsigned int until); // executes translated basic blocks, see block_cache.cpp
+    STOPS6502 run_jit(unsigned int until); // compiles hot blocks to x86-64, see jit.cpp
     byte read(word address) const;
     void write(word address, byte data);
-    void load_memory(byte* memory, word size, word offset) const;
+    void load_memory(const byte* memory, word size, word offset); // copies into RAM
     void push(byte data);
     byte pop();
 
 
+    // memory bus, see bus.cpp. Every page resolves to a direct pointer for reads and
+    // writes unless a device is mapped there. Zero page and stack always map to `memory`,
+    // so the zero page modes and the stack operations index it directly. Other RAM pages
+    // are allocated on their first write and read as zeros until then.
+    byte* memory; // zero page and stack
+    byte* ram_pages[256] = {}; // RAM backing of each page, nullptr until written
+    const byte* read_pages[256]; // nullptr on device pages
+    byte* write_pages[256]; // nullptr on device pages and pages not written since allocation or the last snapshot, ROM pages point at rom_sink
+    BusDevice* devices[256] = {};
+    byte rom_sink[256]; // swallows writes to ROM
+    void map_ram(byte first_page, int pages); // back to the RAM at the same address
+    void map_rom(byte first_page, int pages, const byte* data); // read only, `data` is not copied
+    void map_image(byte first_page, int pages, const byte* data); // copy on write, `data` can be shared by many CPUs
+    void map_bank(byte first_page, int pages, byte* data); // RAM outside the 64KB, `data` is not copied
+    void map_device(byte first_page, int pages, BusDevice* device);
+    void remapped(byte first_page, int pages); // drops cached code of remapped pages
+    byte* ram_page(byte page); // allocates the RAM backing of a page
+    byte* own_page(byte page); // copy on write of the page, see bus.cpp
+    byte* load_target(byte page, bool blank);
+    // block copies into and out of the address space, false and nothing copied if the
+    // range runs past $FFFF or reaches a device page
+    bool dma_write(word address, const byte* data, unsigned int length);
+    bool dma_read(word address, byte* data, unsigned int length);
+    bool dma_reaches_device(word address, unsigned int length, bool writing) const;
+    byte read_device(word address) const; // kept out of the engine loops
+    void write_slow(word address, byte data); // device writes and first writes to a page
+
     // registers
-    byte* memory;
-    byte a, x, y, sp, sb;
+    byte a, x, y, sp, sb; // sb only keeps I, D, B and bit 5, status() is the whole register
     word pc;
+    unsigned long long cycles = 0; // cycles executed since construction, at the start of the current instruction while running
+
+    // N, Z, C and V are stored as the values they derive from and only packed into a
+    // status byte when something reads them, so instructions never read-modify-write sb
+    byte flag_n = 0; // N is bit 7
+    byte flag_z = 1; // Z is set while this is 0
+    byte flag_c = 0; // C is bit 0
+    byte flag_v = 0; // V is set while this is not 0
+
+    // execution engines, selected at runtime
+    enum ENGINES6502{
+        ENGINE_REFERENCE,
+        ENGINE_SWITCH,
+        ENGINE_THREADED,
+        ENGINE_CACHED,
+        ENGINE_BLOCKS,
+        ENGINE_JIT,
+    } engine = ENGINE_REFERENCE;
 
     // flag offsets
     enum FLAGS6502{
@@ -55,6 +256,13 @@ public:
     // helper functions
     void set_flag(FLAGS6502 flag, bool v);
     bool read_flag(FLAGS6502 flag) const;
+    void set_nz(byte value); // N and Z from a result
+    byte branch(); // takes a relative branch, returns the extra cycles
+    void add_binary(byte value); // ADC and SBC arithmetic, see impl_inst.h
+    void add_decimal(byte value);
+    void subtract_decimal(byte value);
+    byte status() const;
+    void set_status(byte value);
     void read_word(word address);
     void read_word(byte low, byte high);
 
@@ -63,7 +271,32 @@ public:
     word abs_addr = 0x0000;
     byte fetched = 0x00;
     word temp = 0x0000;
-    Instruction* current_instruction = nullptr;
+    const Instruction* current_instruction = nullptr;
+
+    // pages holding cached code of either cache, writes to them invalidate the cache
+    bool code_pages[256] = {};
+    void invalidate_code(word address);
+    void flush_code();
+
+    // decode cache, one lazily allocated array of 256 entries per code page
+    DecodedInstruction* decoded_pages[256] = {};
+    bool decode(word address, DecodedInstruction &instruction); // false if a byte of it is on a device page
+    void invalidate_decoded(word address);
+    void flush_decoded();
+
+    // block cache, blocks never cross a page so a page write drops exactly its blocks
+    TranslatedBlock** block_pages[256] = {};
+    std::vector<TranslatedBlock*> retired_blocks; // invalidated while possibly executing
+    bool block_dirty = false; // the running block was invalidated by one of its stores
+    TranslatedBlock* translate(word address);
+    void invalidate_blocks(byte page);
+    void flush_blocks();
+
+    // native code cache, allocated the first time the JIT engine runs
+    JitCache* jit = nullptr;
+    bool compile(word address);
+    void invalidate_jit(byte page);
+    void flush_jit();
 
 
     // Addressing modes:
@@ -72,31 +305,118 @@ public:
         byte zp();  // Zero Page
         byte zpx(); // Zero Page X
         byte zpy(); // Zero Page Y
-        //byte abs();  // Absolute == zp()
+        byte abs(); // Absolute
         byte abx(); // Absolute X
         byte aby(); // Absolute Y
         byte ind(); // Indirect
-        //byte izx();  // Indirect X == zpx()
-        //byte izy(); // Indirect Y == zpy()
+        byte izx(); // Indirect X
+        byte izy(); // Indirect Y
+        byte rel(); // Relative
 
     // Instructions:
     byte ADC(); byte AND(); byte ASL(); byte BCC(); byte BCS(); byte BEQ(); byte BIT(); byte BMI(); byte BNE(); byte BPL(); byte BRK(); byte BVC(); byte BVS(); byte CLC(); byte CLD(); byte CLI(); byte CLV(); byte CMP(); byte CPX(); byte CPY(); byte DEC(); byte DEX(); byte DEY(); byte EOR(); byte INC(); byte INX(); byte INY(); byte JMP(); byte JSR(); byte LDA(); byte LDX(); byte LDY(); byte LSR(); byte NOP(); byte ORA(); byte PHA(); byte PHP(); byte PLA(); byte PLP(); byte ROL(); byte ROR(); byte RTI(); byte RTS(); byte SBC(); byte SEC(); byte SED(); byte SEI(); byte STA(); byte STX(); byte STY(); byte TAX(); byte TAY(); byte TSX(); byte TXA(); byte TXS(); byte TYA();
+    // accumulator forms of the shifts and rotates
+    byte ASL_A(); byte LSR_A(); byte ROL_A(); byte ROR_A();
+    // undocumented opcodes
+    byte JAM(); byte ILL();
 
-    // Opcode lookup table (array of function pointers)
-    Instruction instructions[256];
-
-    void add_instruction(
-            byte opc,
-            const std::string &name, // "NOT NAMED"
-            byte(Dodgy6502::*addr_mode)(),
-            byte(Dodgy6502::*implementation)(),
-            byte cycles,
-            const std::string &description // "NO DESCRIPTION"
-    );
+    // Opcode lookup tables, shared by all instances and built at compile time
+    static const Instruction instructions[256];
+    static const InstructionInfo instruction_info[256];
 
-    void add_all_instructions();
+};
 
+// CPU state saved by Dodgy6502::snapshot(). It points into the CPU's own pages, so it can
+// only be restored into that CPU. Devices keep their own state.
+struct Snapshot {
+    const Dodgy6502* cpu = nullptr;
+    unsigned long long number = 0;
+    byte a = 0, x = 0, y = 0, sp = 0, p = 0;
+    word pc = 0;
+    unsigned long long cycles = 0;
+    unsigned int interrupts = 0;
+    std::vector<Dodgy6502::Event> events;
+    const byte* read_pages[256];
+    byte* write_pages[256];
+    BusDevice* devices[256];
+    int ram_offsets[256]; // of each page's copy in `ram`, -1 for pages without RAM
+    std::vector<byte> ram;
 };
 
+inline void Dodgy6502::set_flag(FLAGS6502 flag, bool v){
+    switch(flag){
+        case N: flag_n = v ? N : 0; break;
+        case Z: flag_z = !v; break;
+        case C: flag_c = v; break;
+        case V: flag_v = v; break;
+        default: if(v) sb |= flag; else sb &= ~flag;
+    }
+}
+
+inline bool Dodgy6502::read_flag(FLAGS6502 flag) const{
+    switch(flag){
+        case N: return flag_n & N;
+        case Z: return !flag_z;
+        case C: return flag_c & C;
+        case V: return flag_v;
+        default: return sb & flag;
+    }
+}
+
+inline void Dodgy6502::set_nz(byte value){
+    flag_n = flag_z = value;
+}
+
+inline byte Dodgy6502::status() const{
+    return (sb & ~(N | Z | C | V)) | (flag_n & N) | (flag_z ? 0 : Z) | (flag_c & C) | (flag_v ? V : 0);
+}
+
+inline void Dodgy6502::set_status(byte value){
+    sb = value & ~(N | Z | C | V);
+    flag_n = value;
+    flag_z = ~value & Z;
+    flag_c = value & C;
+    flag_v = value & V;
+}
+
+inline void Dodgy6502::mark_dirty(byte page){
+    dirty_pages[page >> 6] |= 1ull << (page & 63);
+}
+
+inline void Dodgy6502::irq_unmasked(){
+    if(interrupts && !(sb & I))
+        deadline = 0;
+}
+
+inline byte Dodgy6502::read(word address) const{
+    const byte* page = read_pages[address >> 8];
+    if(DODGY_LIKELY(page))
+        return page[address & 0xff];
+    return read_device(address);
+}
+
+// every write that could hit code goes through here to keep the code caches coherent
+inline void Dodgy6502::write(word address, byte data){
+    byte* page = write_pages[address >> 8];
+    if(!DODGY_LIKELY(page)){
+        write_slow(address, data);
+        return;
+    }
+    page[address & 0xff] = data;
+    if(code_pages[address >> 8])
+        invalidate_code(address);
+}
+
+inline void Dodgy6502::push(byte data){
+    memory[STACK_BASE + sp--] = data;
+}
+
+inline byte Dodgy6502::pop(){
+    return memory[STACK_BASE + ++sp];
+}
+
+#include "addr_modes.h"
+#include "impl_inst.h"
+
 #define INC_6502_6502V2_H
 #endif //INC_6502_6502V2_H
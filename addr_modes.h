@@ -0,0 +1,82 @@
+#pragma once
+// included at the end of 6502v2.h so every engine can inline the addressing modes
+// The indexed modes return 1 when indexing crossed a page, see execute() in dispatch.h
+// Modes outside the zero page only compute abs_addr, the operand is read by the engine
+// for the instructions that need it, see load_operand() in dispatch.h.
+
+inline byte Dodgy6502::imp(){
+    fetched = a;
+    return 0;
+}
+
+inline byte Dodgy6502::imm(){
+    fetched = read(pc++); // max immediate value is 255/0xff
+    return 0;
+}
+
+inline byte Dodgy6502::zp(){
+    abs_addr = read(pc++);
+    fetched = memory[abs_addr];
+    return 0;
+}
+
+inline byte Dodgy6502::zpx(){
+    abs_addr = 0xff & (read(pc++) + x); // wraps around/overflows
+    fetched = memory[abs_addr];
+    return 0;
+}
+
+inline byte Dodgy6502::zpy(){
+    abs_addr = 0xff & (read(pc++) + y); // wraps around/overflows
+    fetched = memory[abs_addr];
+    return 0;
+}
+
+inline byte Dodgy6502::abs(){
+    abs_addr = read(pc) | (read((word)(pc+1)) << 8);
+    pc += 2;
+    return 0;
+}
+
+inline byte Dodgy6502::abx(){
+    word base = read(pc) | (read((word)(pc+1)) << 8);
+    abs_addr = base + x;
+    pc += 2;
+    return (abs_addr ^ base) >> 8 != 0;
+}
+
+inline byte Dodgy6502::aby(){
+    word base = read(pc) | (read((word)(pc+1)) << 8);
+    abs_addr = base + y;
+    pc += 2;
+    return (abs_addr ^ base) >> 8 != 0;
+}
+
+// only used by JMP, reproduces the page wrap bug of the original chip
+inline byte Dodgy6502::ind(){
+    word ind_addr = read(pc) | (read((word)(pc+1)) << 8);
+    pc += 2;
+    abs_addr = read(ind_addr) | (read((ind_addr & 0xff00) | ((ind_addr+1) & 0x00ff)) << 8);
+    return 0;
+}
+
+// adds x to the zero page pointer, pointer wraps around inside the zero page
+inline byte Dodgy6502::izx(){
+    byte ptr = read(pc++) + x;
+    abs_addr = memory[ptr] | (memory[(byte)(ptr+1)] << 8);
+    return 0;
+}
+
+// adds y to the address read from the zero page pointer
+inline byte Dodgy6502::izy(){
+    byte ptr = read(pc++);
+    word base = memory[ptr] | (memory[(byte)(ptr+1)] << 8);
+    abs_addr = base + y;
+    return (abs_addr ^ base) >> 8 != 0;
+}
+
+// branch offset, applied by the branch instructions
+inline byte Dodgy6502::rel(){
+    fetched = read(pc++);
+    return 0;
+}
@@ -0,0 +1,121 @@
+# include "batch.h"
+# include <atomic>
+# include <exception>
+# include <thread>
+
+// Jobs start out split into one contiguous range per worker. A worker takes jobs from the
+// front of its own range and, once that is empty, steals the back half of another one.
+// A range is its begin and end index packed into one 64 bit atomic, so taking and stealing
+// are each a single compare and swap. Each range is padded to its own cache line, which
+// takes C++17: before it std::vector ignored the alignment of its elements. Every CPU
+// lives on the stack of the thread running it, so workers share nothing while running.
+
+namespace {
+
+struct alignas(64) Worker {
+    std::atomic<unsigned long long> range{0};
+    std::exception_ptr error;
+};
+
+unsigned long long pack(unsigned int begin, unsigned int end){
+    return (unsigned long long)end << 32 | begin;
+}
+
+unsigned int range_begin(unsigned long long range){
+    return (unsigned int)range;
+}
+
+unsigned int range_end(unsigned long long range){
+    return range >> 32;
+}
+
+bool take(Worker &worker, unsigned int &job){
+    unsigned long long range = worker.range.load(std::memory_order_acquire);
+    while(range_begin(range) < range_end(range)){
+        if(worker.range.compare_exchange_weak(range, pack(range_begin(range) + 1, range_end(range)), std::memory_order_acq_rel)){
+            job = range_begin(range);
+            return true;
+        }
+    }
+    return false;
+}
+
+// a single job left is never stolen, its owner is about to run it
+bool steal(std::vector<Worker> &workers, unsigned int thief){
+    for(unsigned int i = 1; i < workers.size(); i++){
+        Worker &victim = workers[(thief + i) % workers.size()];
+        unsigned long long range = victim.range.load(std::memory_order_acquire);
+        while(range_begin(range) + 1 < range_end(range)){
+            unsigned int split = range_end(range) - (range_end(range) - range_begin(range)) / 2;
+            if(victim.range.compare_exchange_weak(range, pack(range_begin(range), split), std::memory_order_acq_rel)){
+                workers[thief].range.store(pack(split, range_end(range)), std::memory_order_release);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void run_job(const BatchJob &job, BatchResult &result, const BatchRunner::Inspect &inspect){
+    Dodgy6502 cpu;
+    cpu.engine = job.engine;
+    if(job.rom)
+        cpu.load_rom(*job.rom, job.rom_base);
+    for(const MemoryPatch &patch : job.patches)
+        cpu.load_memory(patch.data.data(), patch.data.size(), patch.address);
+    cpu.pc = job.pc;
+    result.stop = cpu.run_engine(job.budget, job.until);
+    result.cycles = cpu.cycles;
+    result.pc = cpu.pc;
+    result.a = cpu.a;
+    result.x = cpu.x;
+    result.y = cpu.y;
+    result.sp = cpu.sp;
+    result.p = cpu.status();
+    if(inspect)
+        inspect(cpu, job, result);
+}
+
+}
+
+BatchRunner::BatchRunner(unsigned int threads) : threads(threads){
+    if(!this->threads)
+        this->threads = std::thread::hardware_concurrency();
+    if(!this->threads)
+        this->threads = 1;
+}
+
+// an exception thrown by a job stops its worker, the first one is rethrown here
+std::vector<BatchResult> BatchRunner::run(const std::vector<BatchJob> &jobs, const Inspect &inspect) const{
+    std::vector<BatchResult> results(jobs.size());
+    unsigned int count = jobs.size() < threads ? jobs.size() : threads;
+    if(!count)
+        return results;
+    std::vector<Worker> workers(count);
+    for(unsigned int i = 0; i < count; i++)
+        workers[i].range = pack(jobs.size() * i / count, jobs.size() * (i + 1) / count);
+
+    auto work = [&](unsigned int self){
+        try{
+            unsigned int job;
+            do{
+                while(take(workers[self], job))
+                    run_job(jobs[job], results[job], inspect);
+            } while(steal(workers, self));
+        }
+        catch(...){
+            workers[self].error = std::current_exception();
+        }
+    };
+    std::vector<std::thread> pool;
+    for(unsigned int i = 1; i < count; i++)
+        pool.emplace_back(work, i);
+    work(0);
+    for(std::thread &thread : pool)
+        thread.join();
+
+    for(Worker &worker : workers)
+        if(worker.error)
+            std::rethrow_exception(worker.error);
+    return results;
+}
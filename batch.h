@@ -0,0 +1,41 @@
+#pragma once
+#include "6502v2.h"
+#include <functional>
+#include <vector>
+
+// bytes copied into RAM before a batch job starts
+struct MemoryPatch {
+    word address;
+    std::vector<byte> data;
+};
+
+// One independent run. The ROM is loaded copy on write, so all jobs of a batch share
+// one mapping of the firmware and only allocate the pages they write.
+struct BatchJob {
+    const RomFile* rom = nullptr;
+    word rom_base = 0;
+    std::vector<MemoryPatch> patches;
+    word pc = 0;
+    unsigned long long budget = ~0ull;
+    unsigned int until = NO_STOP_PC; // stop address as for run_until()
+    Dodgy6502::ENGINES6502 engine = Dodgy6502::ENGINE_THREADED; // no warm up, no code memory per CPU
+};
+
+struct BatchResult {
+    Dodgy6502::STOPS6502 stop = Dodgy6502::STOP_NONE;
+    unsigned long long cycles = 0;
+    word pc = 0;
+    byte a = 0, x = 0, y = 0, sp = 0, p = 0;
+};
+
+// Runs a batch of jobs on a work stealing thread pool, see batch.cpp. Every job gets a
+// fresh Dodgy6502 on the thread that runs it and writes only its own result slot, so
+// results need no locking. `inspect` is called on that thread after the job stopped,
+// to copy out memory or check the outcome.
+class BatchRunner {
+public:
+    explicit BatchRunner(unsigned int threads = 0); // 0 uses every hardware thread
+    typedef std::function<void(Dodgy6502 &cpu, const BatchJob &job, BatchResult &result)> Inspect;
+    std::vector<BatchResult> run(const std::vector<BatchJob> &jobs, const Inspect &inspect = nullptr) const;
+    unsigned int threads;
+};
@@ -0,0 +1,183 @@
+# include "dispatch.h"
+
+// The block cache translates straight-line code up to the next branch, jump, call or
+// return into an array of predecoded micro ops, fusing common pairs into a single
+// superinstruction. Blocks are looked up once by their start address and then run
+// without going back through the opcode dispatch. Blocks never cross a page, so a
+// write only has to drop the blocks of the page it hit. Like the decode cache, code
+// in the zero page, the stack or a device page is executed uncached, and so is the
+// page holding the run_until() address, which keeps that stop exact without a check
+// per micro op. A start address whose first instruction cannot be translated keeps the
+// empty block `untranslated`, so it goes to the interpreter without another attempt.
+
+// pairs executed by one handler, X(first opcode, second opcode)
+#define DODGY6502_FUSED_PAIRS(X) \
+    X(0xC9, 0xD0) /* CMP imm, BNE */ \
+    X(0xC9, 0xF0) /* CMP imm, BEQ */ \
+    X(0xC5, 0xD0) /* CMP zp,  BNE */ \
+    X(0xC5, 0xF0) /* CMP zp,  BEQ */ \
+    X(0xCD, 0xD0) /* CMP abs, BNE */ \
+    X(0xCD, 0xF0) /* CMP abs, BEQ */ \
+    X(0xE0, 0xD0) /* CPX imm, BNE */ \
+    X(0xC0, 0xD0) /* CPY imm, BNE */ \
+    X(0xA9, 0x85) /* LDA imm, STA zp */ \
+    X(0xA9, 0x8D) /* LDA imm, STA abs */ \
+    X(0xA5, 0x85) /* LDA zp,  STA zp */ \
+    X(0xA5, 0x8D) /* LDA zp,  STA abs */ \
+    X(0xAD, 0x85) /* LDA abs, STA zp */ \
+    X(0xAD, 0x8D) /* LDA abs, STA abs */ \
+    X(0xBD, 0x9D) /* LDA abx, STA abx */ \
+    X(0xB1, 0x91) /* LDA izy, STA izy */ \
+    X(0xCA, 0xD0) /* DEX, BNE */ \
+    X(0x88, 0xD0) /* DEY, BNE */ \
+    X(0xE8, 0xD0) /* INX, BNE */ \
+    X(0xC8, 0xD0) /* INY, BNE */
+
+static TranslatedBlock untranslated; // shared, never freed
+
+static bool ends_block(byte opcode){
+    switch(opcode){
+        case 0x00: // BRK
+        case 0x20: // JSR
+        case 0x40: // RTI
+        case 0x4C: // JMP abs
+        case 0x60: // RTS
+        case 0x6C: // JMP ind
+        case 0x10: case 0x30: case 0x50: case 0x70: // branches
+        case 0x90: case 0xB0: case 0xD0: case 0xF0:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static auto fused_handler(byte first, byte second) -> decltype(DecodedInstruction::handler){
+    switch((first << 8) | second){
+#define FUSED_CASE(first, second) \
+        case (first << 8) | second: return &execute_pair<first, second>;
+        DODGY6502_FUSED_PAIRS(FUSED_CASE)
+#undef FUSED_CASE
+        default: return nullptr;
+    }
+}
+
+TranslatedBlock* Dodgy6502::translate(word address){
+    auto *block = new TranslatedBlock;
+    byte page = address >> 8;
+
+    while(block->count < BLOCK_MAX_OPS && address >> 8 == page){
+        DecodedInstruction &op = block->ops[block->count];
+        if(!decode(address, op) || !op.handler)
+            break; // halts or reads a device page, left to execute_opcode()
+        if((word)(address + op.length - 1) >> 8 != page)
+            break; // reaches into the next page, left to the next lookup
+        block->count++;
+
+        byte opcode = read(address);
+        address += op.length;
+        if(ends_block(opcode))
+            break;
+
+        // fuse with the following instruction if it is a known pair
+        if(address >> 8 != page)
+            break;
+        DecodedInstruction next;
+        if(!decode(address, next))
+            break;
+        auto handler = fused_handler(opcode, read(address));
+        if(handler && (word)(address + next.length - 1) >> 8 == page){
+            op.handler = handler;
+            op.operand2 = next.operand;
+            op.length += next.length;
+            byte second = read(address);
+            address += next.length;
+            if(ends_block(second))
+                break;
+        }
+    }
+
+    if(block->count == 0){
+        delete block;
+        return &untranslated;
+    }
+    return block;
+}
+
+// blocks may still be executing, they are freed from the top of the engine loop
+void Dodgy6502::invalidate_blocks(byte page){
+    TranslatedBlock **blocks = block_pages[page];
+    if(!blocks)
+        return;
+    for(int i = 0; i < 256; i++){
+        if(blocks[i]){
+            if(blocks[i] != &untranslated)
+                retired_blocks.push_back(blocks[i]);
+            blocks[i] = nullptr;
+        }
+    }
+    block_dirty = true;
+}
+
+void Dodgy6502::flush_blocks(){
+    for(auto &blocks : block_pages){
+        if(!blocks)
+            continue;
+        for(int i = 0; i < 256; i++)
+            if(blocks[i] != &untranslated)
+                delete blocks[i];
+        delete[] blocks;
+        blocks = nullptr;
+    }
+    for(auto *block : retired_blocks)
+        delete block;
+    retired_blocks.clear();
+}
+
+DODGY_FLATTEN Dodgy6502::STOPS6502 Dodgy6502::run_blocks(unsigned int until){
+    unsigned long long now = cycles;
+    STOPS6502 stop = STOP_CYCLES;
+    while(now < deadline){
+        if(!retired_blocks.empty()){
+            for(auto *block : retired_blocks)
+                delete block;
+            retired_blocks.clear();
+        }
+
+        TranslatedBlock **blocks = block_pages[pc >> 8];
+        TranslatedBlock *block = nullptr;
+        if(pc >= STACK_BASE + 0x100 && (pc >> 8) != (until >> 8) && read_pages[pc >> 8]){
+            if(!blocks){
+                blocks = block_pages[pc >> 8] = new TranslatedBlock*[256]();
+                code_pages[pc >> 8] = true;
+            }
+            block = blocks[pc & 0xff];
+            if(!block)
+                block = blocks[pc & 0xff] = translate(pc);
+        }
+        if(!block || !block->count){
+            if(pc == until){
+                stop = STOP_PC;
+                break;
+            }
+            cycles = now;
+            byte opcode = read(pc++);
+            byte taken = execute_opcode(*this, opcode);
+            if(!taken){
+                stop = stop_reason(opcode);
+                break;
+            }
+            now += taken;
+            continue;
+        }
+
+        // stop early if a store inside the block rewrote the block's own page
+        block_dirty = false;
+        const DecodedInstruction *op = block->ops, *end = op + block->count;
+        do{
+            cycles = now; // for devices, see scheduler.cpp
+            now += op->handler(*this, *op);
+        } while(++op != end && !block_dirty);
+    }
+    cycles = now;
+    return stop;
+}
@@ -0,0 +1,190 @@
+# include "6502v2.h"
+# include <stdexcept>
+# include <cstring>
+# include <algorithm>
+
+// The bus resolves an address through a 256 entry page table. RAM and ROM pages hold a
+// direct pointer, so read() and write() are an index and a null test; only a device page
+// takes the virtual call. Writes to ROM land in rom_sink instead of being tested for.
+// RAM that was never written reads from blank_page and has no write pointer, its first
+// write takes the slow path and allocates the page. Images are mapped the same way but
+// copied into the RAM page on their first write, so many CPUs can share one firmware.
+
+static const byte blank_page[256] = {};
+
+static void check_pages(byte first_page, int pages){
+    if(first_page < 2)
+        throw std::runtime_error("Zero page and stack have to stay RAM");
+    if(pages < 0 || first_page + pages > 256)
+        throw std::runtime_error("Mapping outside the address space");
+}
+
+void Dodgy6502::map_ram(byte first_page, int pages){
+    if(first_page + pages > 256)
+        throw std::runtime_error("Mapping outside the address space");
+    for(int page = first_page; page < first_page + pages; page++){
+        read_pages[page] = ram_pages[page] ? ram_pages[page] : blank_page;
+        write_pages[page] = ram_pages[page];
+        devices[page] = nullptr;
+    }
+    remapped(first_page, pages);
+}
+
+void Dodgy6502::map_rom(byte first_page, int pages, const byte* data){
+    check_pages(first_page, pages);
+    for(int i = 0; i < pages; i++){
+        read_pages[first_page + i] = data + (i << 8);
+        write_pages[first_page + i] = rom_sink;
+        devices[first_page + i] = nullptr;
+    }
+    remapped(first_page, pages);
+}
+
+void Dodgy6502::map_image(byte first_page, int pages, const byte* data){
+    check_pages(first_page, pages);
+    for(int i = 0; i < pages; i++){
+        read_pages[first_page + i] = data + (i << 8);
+        write_pages[first_page + i] = nullptr;
+        devices[first_page + i] = nullptr;
+    }
+    remapped(first_page, pages);
+}
+
+void Dodgy6502::map_bank(byte first_page, int pages, byte* data){
+    check_pages(first_page, pages);
+    for(int i = 0; i < pages; i++){
+        read_pages[first_page + i] = write_pages[first_page + i] = data + (i << 8);
+        devices[first_page + i] = nullptr;
+    }
+    remapped(first_page, pages);
+}
+
+void Dodgy6502::map_device(byte first_page, int pages, BusDevice* device){
+    check_pages(first_page, pages);
+    for(int page = first_page; page < first_page + pages; page++){
+        read_pages[page] = nullptr;
+        write_pages[page] = nullptr;
+        devices[page] = device;
+    }
+    remapped(first_page, pages);
+}
+
+DODGY_NOINLINE byte Dodgy6502::read_device(word address) const{
+    return devices[address >> 8]->read(address);
+}
+
+// A page mapped as RAM but not written yet starts using its page right away. The page
+// can exist already if restore() took the mapping back, it zeroed the page then.
+byte* Dodgy6502::ram_page(byte page){
+    if(!ram_pages[page])
+        ram_pages[page] = new byte[256]();
+    if(read_pages[page] == blank_page && !devices[page])
+        read_pages[page] = write_pages[page] = ram_pages[page];
+    return ram_pages[page];
+}
+
+DODGY_NOINLINE void Dodgy6502::write_slow(word address, byte data){
+    byte page = address >> 8;
+    if(devices[page]){
+        devices[page]->write(address, data);
+        return;
+    }
+    own_page(page); // also ends the write protection of a snapshot
+    mark_dirty(page);
+    write(address, data);
+}
+
+// copy on write: the page's own RAM takes over what it reads, ROM stays read only
+byte* Dodgy6502::own_page(byte page){
+    byte* own = ram_page(page);
+    if(read_pages[page] != own)
+        memcpy(own, read_pages[page], 256);
+    read_pages[page] = own;
+    if(write_pages[page] != rom_sink)
+        write_pages[page] = own;
+    return own;
+}
+
+// What load_memory() copies into: banks and written RAM directly, an image or ROM page in
+// a copy of its own, so the patch is what the CPU reads, and the RAM behind a device. A
+// blank chunk needs no page that only reads blank anyway.
+byte* Dodgy6502::load_target(byte page, bool blank){
+    if(devices[page])
+        return ram_pages[page] || !blank ? ram_page(page) : nullptr;
+    if(write_pages[page] && write_pages[page] != rom_sink)
+        return write_pages[page];
+    if(blank && read_pages[page] == blank_page)
+        return nullptr;
+    return own_page(page);
+}
+
+// DMA copies a page at a time. Mapped pages take a memcpy and drop their cached code like
+// a remap would, RAM not written yet goes through the bus byte by byte. A transfer that
+// touches a device page or runs past $FFFF is refused before any byte moves, a DMA
+// controller has no business triggering the side effects of registers.
+bool Dodgy6502::dma_reaches_device(word address, unsigned int length, bool writing) const{
+    if(length > 0x10000u - address)
+        return true;
+    for(unsigned int page = address >> 8; length && page <= (address + length - 1u) >> 8; page++)
+        if(writing ? !write_pages[page] && devices[page] : !read_pages[page])
+            return true;
+    return false;
+}
+
+bool Dodgy6502::dma_write(word address, const byte* data, unsigned int length){
+    if(dma_reaches_device(address, length, true))
+        return false;
+    while(length){
+        byte page = address >> 8;
+        unsigned int chunk = std::min(length, 0x100u - (address & 0xff));
+        byte* target = write_pages[page];
+        if(target == rom_sink)
+            ; // ROM ignores the transfer
+        else if(target){
+            memcpy(target + (address & 0xff), data, chunk);
+            remapped(page, 1);
+        }
+        else
+            for(unsigned int i = 0; i < chunk; i++)
+                write(address + i, data[i]);
+        address += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+    return true;
+}
+
+bool Dodgy6502::dma_read(word address, byte* data, unsigned int length){
+    if(dma_reaches_device(address, length, false))
+        return false;
+    while(length){
+        unsigned int chunk = std::min(length, 0x100u - (address & 0xff));
+        memcpy(data, read_pages[address >> 8] + (address & 0xff), chunk);
+        address += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+    return true;
+}
+
+// Only the caches of the remapped pages are dropped. Decoded entries are cleared rather
+// than freed since the instruction that wrote a mapping register may still be running,
+// the two entries in front of the range go too as their operands can reach into it.
+// Pages no cache holds code of are skipped, so switching a data bank only costs the
+// page table stores. Remapped pages count as dirty for the next restore().
+void Dodgy6502::remapped(byte first_page, int pages){
+    if(pages <= 0)
+        return;
+    if(code_pages[first_page])
+        invalidate_decoded(first_page << 8);
+    for(int page = first_page; page < first_page + pages; page++){
+        mark_dirty(page);
+        if(!code_pages[page])
+            continue;
+        if(DecodedInstruction *decoded = decoded_pages[page])
+            for(int i = 0; i < 256; i++)
+                decoded[i].handler = nullptr;
+        invalidate_blocks(page);
+        invalidate_jit(page);
+    }
+}
@@ -0,0 +1,93 @@
+# include "console.h"
+# include <chrono>
+# include <cerrno>
+# include <poll.h>
+# include <unistd.h>
+
+// The emulated side never blocks on the host: a write only queues the character and
+// wakes the writer thread if it went to sleep, a read only takes what the reader thread
+// already queued. The writer hands everything queued to one write() call, so a burst of
+// log output costs a syscall per chunk instead of one per character. A full output queue
+// makes the firmware wait rather than lose output.
+
+Console::Console(int out_fd, int in_fd) : out_fd(out_fd), in_fd(in_fd){
+    writer = std::thread(&Console::write_output, this);
+    if(in_fd >= 0)
+        reader = std::thread(&Console::read_input, this);
+}
+
+Console::~Console(){
+    stopping = true;
+    writer_wake.notify_one();
+    writer.join();
+    if(reader.joinable())
+        reader.join();
+}
+
+byte Console::read(word address){
+    if(address & 1)
+        return (input.empty() ? 0 : INPUT_READY) | (output.full() ? 0 : OUTPUT_READY);
+    byte data = 0;
+    input.pop(data);
+    return data;
+}
+
+void Console::write(word address, byte data){
+    if(address & 1)
+        return;
+    while(!output.push(data)){
+        writer_wake.notify_one();
+        std::this_thread::yield();
+    }
+    if(writer_waiting.load(std::memory_order_relaxed))
+        writer_wake.notify_one();
+}
+
+void Console::flush(){
+    while(!output.empty()){
+        writer_wake.notify_one();
+        std::this_thread::yield();
+    }
+}
+
+// A wake up lost between the check and the wait only delays output by the wait timeout.
+// Output the host refuses is dropped so the firmware cannot hang on it.
+void Console::write_output(){
+    for(;;){
+        bool stop = stopping;
+        unsigned int count;
+        const byte* chunk = output.peek(count);
+        if(count){
+            ssize_t written = ::write(out_fd, chunk, count);
+            if(written < 0 && errno == EINTR)
+                continue;
+            output.consume(written > 0 ? written : count);
+            continue;
+        }
+        if(stop)
+            return;
+        std::unique_lock<std::mutex> lock(writer_lock);
+        writer_waiting = true;
+        if(output.empty() && !stopping)
+            writer_wake.wait_for(lock, std::chrono::milliseconds(10));
+        writer_waiting = false;
+    }
+}
+
+// polls so the thread notices `stopping` without input arriving
+void Console::read_input(){
+    pollfd fd = {in_fd, POLLIN, 0};
+    byte buffer[256];
+    while(!stopping){
+        if(poll(&fd, 1, 50) <= 0)
+            continue;
+        ssize_t count = ::read(in_fd, buffer, sizeof buffer);
+        if(count < 0 && errno == EINTR)
+            continue;
+        if(count <= 0)
+            return; // end of input
+        for(ssize_t i = 0; i < count; i++)
+            while(!input.push(buffer[i]) && !stopping)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include "6502v2.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Single producer single consumer byte queue. The two threads only share the two
+// indices, each keeps a copy of the other one's index and reloads it when the queue
+// looks full or empty, so a push or pop usually touches no shared cache line.
+template<unsigned int SIZE>
+class ByteRing {
+    static_assert((SIZE & (SIZE - 1)) == 0, "ring size has to be a power of two");
+public:
+    bool push(byte value){
+        unsigned int tail = tail_.load(std::memory_order_relaxed);
+        if(tail - head_seen == SIZE){
+            head_seen = head_.load(std::memory_order_acquire);
+            if(tail - head_seen == SIZE)
+                return false;
+        }
+        data[tail & (SIZE - 1)] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(byte &value){
+        unsigned int head = head_.load(std::memory_order_relaxed);
+        if(head == tail_seen){
+            tail_seen = tail_.load(std::memory_order_acquire);
+            if(head == tail_seen)
+                return false;
+        }
+        value = data[head & (SIZE - 1)];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side, the queued bytes up to the end of the buffer
+    const byte* peek(unsigned int &count){
+        unsigned int head = head_.load(std::memory_order_relaxed);
+        tail_seen = tail_.load(std::memory_order_acquire);
+        unsigned int end = SIZE - (head & (SIZE - 1));
+        count = tail_seen - head < end ? tail_seen - head : end;
+        return data + (head & (SIZE - 1));
+    }
+    void consume(unsigned int count){
+        head_.store(head_.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+    // from either side
+    bool empty() const{
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+    bool full() const{
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire) == SIZE;
+    }
+
+private:
+    alignas(64) std::atomic<unsigned int> head_{0};
+    unsigned int tail_seen = 0; // consumer's copy of tail_
+    alignas(64) std::atomic<unsigned int> tail_{0};
+    unsigned int head_seen = 0; // producer's copy of head_
+    alignas(64) byte data[SIZE];
+};
+
+// Character I/O for firmware, see console.cpp. Map it with Dodgy6502::map_device(), the
+// two registers repeat over the page:
+//   +0 data, a write queues a character for output, a read takes the next input character or 0
+//   +1 status, bit 0 set when input is waiting, bit 1 set when output has room
+// Output is written by a host thread, so firmware printing never waits on a syscall.
+// Input is read from `in_fd` by another thread, pass -1 to have none.
+class Console : public BusDevice {
+public:
+    explicit Console(int out_fd = 1, int in_fd = 0);
+    ~Console() override; // writes out everything still queued
+    byte read(word address) override;
+    void write(word address, byte data) override;
+    void flush(); // waits until the queued output is written
+
+    enum REGISTERSCONSOLE{
+        DATA, STATUS
+    };
+    enum STATUSCONSOLE{
+        INPUT_READY = (1 << 0),
+        OUTPUT_READY = (1 << 1),
+    };
+
+private:
+    int out_fd, in_fd;
+    ByteRing<1 << 16> output;
+    ByteRing<1 << 12> input;
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> writer_waiting{false};
+    std::mutex writer_lock;
+    std::condition_variable writer_wake;
+    std::thread writer, reader;
+    void write_output();
+    void read_input();
+};
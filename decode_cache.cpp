@@ -0,0 +1,94 @@
+# include "dispatch.h"
+
+// The decode cache keeps one DecodedInstruction per address of every page code has been
+// executed from. Entries hold the handler and operand so hot loops skip the opcode
+// table and the operand fetch; write() drops the entries a store could have changed.
+// Zero page, stack and device pages are never cached, code running there and
+// instructions whose operand lies on a device page take the switch path.
+// Halting opcodes keep a null handler, so reaching one always takes the miss path and
+// the loop never tests for them on a hit.
+
+// Reads the opcode and only the operand bytes its mode has, like the chip does. An
+// instruction with a byte on a device page is not decoded, reading it ahead of time
+// would take device reads the chip does not do, the caller executes it uncached.
+bool Dodgy6502::decode(word address, DecodedInstruction &instruction){
+    if(!read_pages[address >> 8])
+        return false;
+    byte opcode = read(address);
+    switch(opcode){
+#define DECODE_CASE(opc, name, mode, impl, cycles, description) \
+        case opc: \
+            instruction.handler = Opcode<opc>::halts ? nullptr : &execute_decoded<&Dodgy6502::mode, &Dodgy6502::impl, cycles>; \
+            instruction.length = Opcode<opc>::length; \
+            break;
+        DODGY6502_OPCODES(DECODE_CASE)
+#undef DECODE_CASE
+    }
+    word last = address + instruction.length - 1;
+    if(!read_pages[last >> 8]){
+        instruction.handler = nullptr;
+        return false;
+    }
+    instruction.operand = 0;
+    if(instruction.length > 1)
+        instruction.operand = read(address + 1);
+    if(instruction.length > 2)
+        instruction.operand |= read(address + 2) << 8;
+
+    // an instruction reaching into the next page must see writes to that page too
+    code_pages[last >> 8] = true;
+    return true;
+}
+
+// an instruction is at most 3 bytes long, so a write can change the one starting at
+// the written address or at one of the two before it
+void Dodgy6502::invalidate_decoded(word address){
+    for(word i = 0; i < 3; i++){
+        word start = address - i;
+        if(DecodedInstruction *page = decoded_pages[start >> 8])
+            page[start & 0xff].handler = nullptr;
+    }
+}
+
+void Dodgy6502::flush_decoded(){
+    for(auto &page : decoded_pages){
+        delete[] page;
+        page = nullptr;
+    }
+}
+
+DODGY_FLATTEN Dodgy6502::STOPS6502 Dodgy6502::run_cached(unsigned int until){
+    unsigned long long now = cycles;
+    STOPS6502 stop = STOP_CYCLES;
+    while(now < deadline){
+        if(pc == until){
+            stop = STOP_PC;
+            break;
+        }
+        cycles = now; // for devices, see scheduler.cpp
+
+        DecodedInstruction *page = decoded_pages[pc >> 8];
+        if(!page && pc >= STACK_BASE + 0x100 && read_pages[pc >> 8]){
+            page = decoded_pages[pc >> 8] = new DecodedInstruction[256];
+            code_pages[pc >> 8] = true;
+        }
+        if(page){
+            DecodedInstruction &instruction = page[pc & 0xff];
+            if(instruction.handler || (decode(pc, instruction) && instruction.handler)){
+                now += instruction.handler(*this, instruction);
+                continue;
+            }
+        }
+
+        // not cached: zero page, stack, device pages, operands on a device page and halts
+        byte opcode = read(pc++);
+        byte taken = execute_opcode(*this, opcode);
+        if(!taken){
+            stop = stop_reason(opcode);
+            break;
+        }
+        now += taken;
+    }
+    cycles = now;
+    return stop;
+}
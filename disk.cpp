@@ -0,0 +1,101 @@
+# include "disk.h"
+# include <stdexcept>
+# include <fcntl.h>
+# include <unistd.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+
+// The image is mapped shared, so a sector transfer is a copy between the mapping and the
+// emulated address space through Dodgy6502::dma_write() and dma_read(). The page cache
+// does the file I/O, CMD_FLUSH only has to sync the mapping. Commands complete at once.
+// A transfer that would run past $FFFF or reach a device page, the disk's own registers
+// among them, fails with DISK_ERROR and moves nothing.
+
+Disk::Disk(Dodgy6502 &cpu, const char* filename, bool writable) : cpu(cpu), writable(writable){
+    int fd = open(filename, writable ? O_RDWR : O_RDONLY);
+    if(fd < 0 && writable){
+        this->writable = false;
+        fd = open(filename, O_RDONLY);
+    }
+    if(fd < 0)
+        throw std::runtime_error("Failed to open disk image");
+    struct stat info;
+    if(fstat(fd, &info) != 0){
+        close(fd);
+        throw std::runtime_error("Failed reading disk image");
+    }
+    size = info.st_size;
+    if(size){
+        void* mapping = mmap(nullptr, size, this->writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+        if(mapping == MAP_FAILED){
+            close(fd);
+            throw std::runtime_error("Failed reading disk image");
+        }
+        image = (byte*)mapping;
+    }
+    close(fd); // the mapping stays valid
+    if(!this->writable)
+        status = DISK_READ_ONLY;
+}
+
+Disk::~Disk(){
+    if(image)
+        munmap(image, size);
+}
+
+byte Disk::read(word address){
+    switch(address & 7){
+        case SECTOR_LOW: return sector;
+        case SECTOR_MID: return sector >> 8;
+        case SECTOR_HIGH: return sector >> 16;
+        case DMA_LOW: return dma;
+        case DMA_HIGH: return dma >> 8;
+        case COUNT: return count;
+        case COMMAND: return 0;
+        default: return status;
+    }
+}
+
+void Disk::write(word address, byte data){
+    switch(address & 7){
+        case SECTOR_LOW: sector = (sector & 0xffff00) | data; break;
+        case SECTOR_MID: sector = (sector & 0xff00ff) | (data << 8); break;
+        case SECTOR_HIGH: sector = (sector & 0x00ffff) | (data << 16); break;
+        case DMA_LOW: dma = (dma & 0xff00) | data; break;
+        case DMA_HIGH: dma = (dma & 0x00ff) | (data << 8); break;
+        case COUNT: count = data; break;
+        case COMMAND: run(data); break;
+        default: break;
+    }
+}
+
+// DMA never reaches a device page, so a transfer cannot write a command to the disk
+// while one runs
+void Disk::run(byte command){
+    status &= ~DISK_ERROR;
+    if(!transfer(command))
+        status |= DISK_ERROR;
+}
+
+bool Disk::transfer(byte command){
+    unsigned int sectors = count ? count : 256;
+    unsigned int length = sectors * SECTOR_SIZE;
+    bool in_range = (size_t)(sector + sectors) * SECTOR_SIZE <= size;
+    switch(command){
+        case CMD_READ:
+            if(!in_range || !cpu.dma_write(dma, image + (size_t)sector * SECTOR_SIZE, length))
+                return false;
+            break;
+        case CMD_WRITE:
+            if(!in_range || !writable || !cpu.dma_read(dma, image + (size_t)sector * SECTOR_SIZE, length))
+                return false;
+            break;
+        case CMD_FLUSH:
+            return !image || msync(image, size, MS_SYNC) == 0;
+        default:
+            return false;
+    }
+    sector += sectors;
+    dma += length;
+    return true;
+}
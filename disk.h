@@ -0,0 +1,46 @@
+#pragma once
+#include "6502v2.h"
+
+// Block device backed by a disk image, see disk.cpp. Map it with Dodgy6502::map_device(),
+// the registers repeat every 8 bytes:
+//   +0..+2 sector number, low byte first
+//   +3..+4 DMA address, low byte first
+//   +5     sectors to transfer, 0 transfers 256
+//   +6     command, writing one runs it to completion
+//   +7     status, DISK_ERROR when the last command failed
+// A transfer advances the sector number and the DMA address past the transferred data.
+class Disk : public BusDevice {
+public:
+    Disk(Dodgy6502 &cpu, const char* filename, bool writable = true);
+    ~Disk() override;
+    Disk(const Disk&) = delete;
+    Disk& operator=(const Disk&) = delete;
+    byte read(word address) override;
+    void write(word address, byte data) override;
+
+    static const unsigned int SECTOR_SIZE = 256;
+    enum REGISTERSDISK{
+        SECTOR_LOW, SECTOR_MID, SECTOR_HIGH, DMA_LOW, DMA_HIGH, COUNT, COMMAND, STATUS
+    };
+    enum COMMANDSDISK{
+        CMD_READ = 1, // disk to memory
+        CMD_WRITE = 2, // memory to disk
+        CMD_FLUSH = 3, // written sectors to the image file
+    };
+    enum STATUSDISK{
+        DISK_ERROR = (1 << 0),
+        DISK_READ_ONLY = (1 << 6),
+    };
+
+private:
+    Dodgy6502 &cpu;
+    byte* image = nullptr;
+    size_t size = 0;
+    bool writable;
+    unsigned int sector = 0;
+    word dma = 0;
+    byte count = 1;
+    byte status = 0;
+    void run(byte command);
+    bool transfer(byte command); // false for DISK_ERROR
+};
@@ -0,0 +1,270 @@
+#pragma once
+# include "6502v2.h"
+# include "opcodes.h"
+
+// Implementations that stop a run in front of themselves instead of being executed.
+// The compiled engines know this per opcode at compile time and never call them.
+template<byte(Dodgy6502::*implementation)()> struct Halts{ static const Dodgy6502::STOPS6502 reason = Dodgy6502::STOP_NONE; };
+template<> struct Halts<&Dodgy6502::BRK>{ static const Dodgy6502::STOPS6502 reason = Dodgy6502::STOP_BRK; };
+template<> struct Halts<&Dodgy6502::JAM>{ static const Dodgy6502::STOPS6502 reason = Dodgy6502::STOP_JAM; };
+template<> struct Halts<&Dodgy6502::ILL>{ static const Dodgy6502::STOPS6502 reason = Dodgy6502::STOP_INVALID; };
+
+#define COUNT_OPCODE(opc, name, mode, impl, cycles, description) + 1
+static_assert(0 DODGY6502_OPCODES(COUNT_OPCODE) == 256, "every opcode needs an entry in opcodes.h");
+#undef COUNT_OPCODE
+
+// Cycles an instruction takes on top of its base cycles, from what its addressing mode
+// and implementation returned. A page crossing only costs the instructions that read.
+template<byte(Dodgy6502::*addr_mode)()>
+static inline byte extra_cycles(byte crossed, byte extra){
+    return addr_mode == &Dodgy6502::rel ? extra : crossed & extra;
+}
+
+// Whether an instruction reads the operand at the address a mode outside the zero page
+// computed. Stores and jumps do not, so they never touch a device register the real chip
+// leaves alone. A constant after inlining in the compiled engines.
+static inline bool loads_operand(byte(Dodgy6502::*addr_mode)(), byte(Dodgy6502::*implementation)()){
+    bool computed = addr_mode == &Dodgy6502::abs || addr_mode == &Dodgy6502::abx || addr_mode == &Dodgy6502::aby ||
+                    addr_mode == &Dodgy6502::izx || addr_mode == &Dodgy6502::izy;
+    bool ignores = implementation == &Dodgy6502::STA || implementation == &Dodgy6502::STX ||
+                   implementation == &Dodgy6502::STY || implementation == &Dodgy6502::JMP ||
+                   implementation == &Dodgy6502::JSR;
+    return computed && !ignores;
+}
+
+template<byte(Dodgy6502::*addr_mode)(), byte(Dodgy6502::*implementation)()>
+static inline void load_operand(Dodgy6502 &cpu){
+    if(loads_operand(addr_mode, implementation))
+        cpu.fetched = cpu.read(cpu.abs_addr);
+}
+
+// Every opcode gets its own handler: the addressing mode and the implementation are
+// template arguments, so both calls are direct and get inlined into the engine loop.
+// Returns the cycles taken, or 0 with pc moved back onto the opcode if it halts. The
+// halt is a constant after inlining, so the check costs nothing on the other opcodes.
+template<byte(Dodgy6502::*addr_mode)(), byte(Dodgy6502::*implementation)(), byte cycles>
+static inline byte execute(Dodgy6502 &cpu){
+    if(Halts<implementation>::reason != Dodgy6502::STOP_NONE){
+        cpu.pc--;
+        return 0;
+    }
+    byte crossed = (cpu.*addr_mode)();
+    load_operand<addr_mode, implementation>(cpu);
+    byte extra = (cpu.*implementation)();
+    return cycles + extra_cycles<addr_mode>(crossed, extra);
+}
+
+// executes a single opcode whose byte has already been fetched, same result as execute()
+static inline byte execute_opcode(Dodgy6502 &cpu, byte opcode){
+    switch(opcode){
+#define SWITCH_CASE(opc, name, mode, impl, cycles, description) \
+        case opc: return execute<&Dodgy6502::mode, &Dodgy6502::impl, cycles>(cpu);
+        DODGY6502_OPCODES(SWITCH_CASE)
+#undef SWITCH_CASE
+    }
+    return 0; // not reached, every opcode has a case
+}
+
+// why the opcode pc points at halted, only looked at once a handler returned 0
+static inline Dodgy6502::STOPS6502 stop_reason(byte opcode){
+    switch(opcode){
+#define STOP_CASE(opc, name, mode, impl, cycles, description) \
+        case opc: return Halts<&Dodgy6502::impl>::reason;
+        DODGY6502_OPCODES(STOP_CASE)
+#undef STOP_CASE
+    }
+    return Dodgy6502::STOP_NONE;
+}
+
+// Whether an implementation can leave pc anywhere but on the next instruction. A constant
+// after inlining like loads_operand().
+static inline bool transfers_control(byte(Dodgy6502::*implementation)()){
+    return implementation == &Dodgy6502::BCC || implementation == &Dodgy6502::BCS ||
+           implementation == &Dodgy6502::BEQ || implementation == &Dodgy6502::BMI ||
+           implementation == &Dodgy6502::BNE || implementation == &Dodgy6502::BPL ||
+           implementation == &Dodgy6502::BVC || implementation == &Dodgy6502::BVS ||
+           implementation == &Dodgy6502::JMP || implementation == &Dodgy6502::JSR ||
+           implementation == &Dodgy6502::RTS || implementation == &Dodgy6502::RTI;
+}
+
+// Instrumentation of switch_loop() is a policy type, so it is compiled into the loops
+// that ask for it only. edge() sees every control transfer, a branch not taken included,
+// with the address of the instruction and the pc it left. The engines run NoCoverage.
+struct NoCoverage {
+    void edge(word, word) {}
+};
+
+template<byte(Dodgy6502::*addr_mode)(), byte(Dodgy6502::*implementation)(), byte cycles, class Coverage>
+static inline byte execute_covered(Dodgy6502 &cpu, word from, Coverage &coverage){
+    byte taken = execute<addr_mode, implementation, cycles>(cpu);
+    if(transfers_control(implementation) && taken)
+        coverage.edge(from, cpu.pc);
+    return taken;
+}
+
+// The loop of run_switch(), instrumented through `coverage`. Like the threaded and cached
+// loops it keeps only the cycle count in a local for the whole run. pc and the registers
+// stay members: the handlers are Dodgy6502 members shared by every engine, and moving
+// them into locals would take a second set of handlers working on a register copy. The
+// price is a reload of a register after a store through the page tables, which may
+// alias the CPU.
+template<class Coverage>
+static inline Dodgy6502::STOPS6502 switch_loop(Dodgy6502 &cpu, unsigned int until, Coverage &coverage){
+    unsigned long long now = cpu.cycles;
+    Dodgy6502::STOPS6502 stop = Dodgy6502::STOP_CYCLES;
+    while(now < cpu.deadline){
+        if(cpu.pc == until){
+            stop = Dodgy6502::STOP_PC;
+            break;
+        }
+        cpu.cycles = now; // for devices, see scheduler.cpp
+        word from = cpu.pc;
+        byte opcode = cpu.read(cpu.pc++);
+        byte taken = 0;
+        switch(opcode){
+#define COVERED_CASE(opc, name, mode, impl, cycles, description) \
+            case opc: taken = execute_covered<&Dodgy6502::mode, &Dodgy6502::impl, cycles>(cpu, from, coverage); break;
+            DODGY6502_OPCODES(COVERED_CASE)
+#undef COVERED_CASE
+        }
+        if(!taken){
+            stop = stop_reason(opcode);
+            break;
+        }
+        now += taken;
+    }
+    cpu.cycles = now;
+    return stop;
+}
+
+// Addressing modes for instructions whose operand bytes were read ahead of time by a
+// cache. `length` is the size of the whole instruction, `resolve` does what the
+// matching function in addr_modes.h does after fetching the operand and returns the same.
+template<byte(Dodgy6502::*addr_mode)()> struct Predecoded;
+
+template<> struct Predecoded<&Dodgy6502::imp>{
+    static const byte length = 1;
+    static inline byte resolve(Dodgy6502 &cpu, word){ cpu.fetched = cpu.a; return 0; }
+};
+
+template<> struct Predecoded<&Dodgy6502::imm>{
+    static const byte length = 2;
+    static inline byte resolve(Dodgy6502 &cpu, word operand){ cpu.fetched = operand; return 0; }
+};
+
+template<> struct Predecoded<&Dodgy6502::rel>{
+    static const byte length = 2;
+    static inline byte resolve(Dodgy6502 &cpu, word operand){ cpu.fetched = operand; return 0; }
+};
+
+template<> struct Predecoded<&Dodgy6502::zp>{
+    static const byte length = 2;
+    static inline byte resolve(Dodgy6502 &cpu, word operand){
+        cpu.abs_addr = operand;
+        cpu.fetched = cpu.memory[operand];
+        return 0;
+    }
+};
+
+template<> struct Predecoded<&Dodgy6502::zpx>{
+    static const byte length = 2;
+    static inline byte resolve(Dodgy6502 &cpu, word operand){
+        cpu.abs_addr = 0xff & (operand + cpu.x);
+        cpu.fetched = cpu.memory[cpu.abs_addr];
+        return 0;
+    }
+};
+
+template<> struct Predecoded<&Dodgy6502::zpy>{
+    static const byte length = 2;
+    static inline byte resolve(Dodgy6502 &cpu, word operand){
+        cpu.abs_addr = 0xff & (operand + cpu.y);
+        cpu.fetched = cpu.memory[cpu.abs_addr];
+        return 0;
+    }
+};
+
+template<> struct Predecoded<&Dodgy6502::izx>{
+    static const byte length = 2;
+    static inline byte resolve(Dodgy6502 &cpu, word operand){
+        byte ptr = operand + cpu.x;
+        cpu.abs_addr = cpu.memory[ptr] | (cpu.memory[(byte)(ptr+1)] << 8);
+        return 0;
+    }
+};
+
+template<> struct Predecoded<&Dodgy6502::izy>{
+    static const byte length = 2;
+    static inline byte resolve(Dodgy6502 &cpu, word operand){
+        word base = cpu.memory[operand] | (cpu.memory[(byte)(operand+1)] << 8);
+        cpu.abs_addr = base + cpu.y;
+        return (cpu.abs_addr ^ base) >> 8 != 0;
+    }
+};
+
+template<> struct Predecoded<&Dodgy6502::abs>{
+    static const byte length = 3;
+    static inline byte resolve(Dodgy6502 &cpu, word operand){
+        cpu.abs_addr = operand;
+        return 0;
+    }
+};
+
+template<> struct Predecoded<&Dodgy6502::abx>{
+    static const byte length = 3;
+    static inline byte resolve(Dodgy6502 &cpu, word operand){
+        cpu.abs_addr = operand + cpu.x;
+        return (cpu.abs_addr ^ operand) >> 8 != 0;
+    }
+};
+
+template<> struct Predecoded<&Dodgy6502::aby>{
+    static const byte length = 3;
+    static inline byte resolve(Dodgy6502 &cpu, word operand){
+        cpu.abs_addr = operand + cpu.y;
+        return (cpu.abs_addr ^ operand) >> 8 != 0;
+    }
+};
+
+template<> struct Predecoded<&Dodgy6502::ind>{
+    static const byte length = 3;
+    static inline byte resolve(Dodgy6502 &cpu, word operand){
+        cpu.abs_addr = cpu.read(operand) | (cpu.read((operand & 0xff00) | ((operand+1) & 0x00ff)) << 8);
+        return 0;
+    }
+};
+
+// an opcode whose operand bytes were already read, pc still points at the opcode.
+// Halting opcodes are never decoded, the caches leave them to execute_opcode().
+template<byte(Dodgy6502::*addr_mode)(), byte(Dodgy6502::*implementation)(), byte cycles>
+struct PredecodedOpcode{
+    static const byte length = Predecoded<addr_mode>::length;
+    static const bool halts = Halts<implementation>::reason != Dodgy6502::STOP_NONE;
+    static inline byte execute(Dodgy6502 &cpu, word operand){
+        cpu.pc += length;
+        byte crossed = Predecoded<addr_mode>::resolve(cpu, operand);
+        load_operand<addr_mode, implementation>(cpu);
+        byte extra = (cpu.*implementation)();
+        return cycles + extra_cycles<addr_mode>(crossed, extra);
+    }
+};
+
+// handler stored in a DecodedInstruction
+template<byte(Dodgy6502::*addr_mode)(), byte(Dodgy6502::*implementation)(), byte cycles>
+static byte execute_decoded(Dodgy6502 &cpu, const DecodedInstruction &instruction){
+    return PredecodedOpcode<addr_mode, implementation, cycles>::execute(cpu, instruction.operand);
+}
+
+// compile-time lookup of an opcode's predecoded form
+template<byte opc> struct Opcode;
+#define OPCODE_TRAITS(opc, name, mode, impl, cycles, description) \
+template<> struct Opcode<opc> : PredecodedOpcode<&Dodgy6502::mode, &Dodgy6502::impl, cycles>{};
+DODGY6502_OPCODES(OPCODE_TRAITS)
+#undef OPCODE_TRAITS
+
+// superinstruction: two predecoded instructions executed by a single handler
+template<byte first, byte second>
+static byte execute_pair(Dodgy6502 &cpu, const DecodedInstruction &instruction){
+    byte taken = Opcode<first>::execute(cpu, instruction.operand);
+    return taken + Opcode<second>::execute(cpu, instruction.operand2);
+}
@@ -0,0 +1,174 @@
+# include "fleet.h"
+# include <stdexcept>
+
+// The engines already return at a cycle budget with all of their state in the CPU, so an
+// instance needs no coroutine or stack of its own: a slice is a run_engine() call of one
+// quantum and the next slice resumes where it stopped, on whichever thread takes it.
+// Runnable instances wait in one queue and go to its back after their slice, so every
+// one gets its quantum in turn. Parked instances are in no queue and cost nothing until
+// wake(), post() or grant() queues them again.
+//
+// An instance parks when it halts, runs out of quota, reaches its idle pc or sits on a
+// JMP to itself, the idle loop of firmware that waits for an interrupt. Interrupts are
+// raised through post(), which wakes it, and are taken in front of the next slice. A slice
+// that starts on the idle pc steps over it first, so an instance parked in a loop polling
+// for I/O runs the loop once per wake up and parks again until the I/O arrived. Only an
+// instance without pending device events parks: the events of a parked one would never
+// come due. A JMP to itself waiting for one skips ahead to it instead of spinning.
+
+namespace {
+
+// looks at mapped memory only, reading a device register could have side effects
+bool jumps_to_itself(const Dodgy6502 &cpu){
+    word pc = cpu.pc, last = pc + 2;
+    if(!cpu.read_pages[pc >> 8] || !cpu.read_pages[last >> 8])
+        return false;
+    return cpu.read(pc) == 0x4c && (cpu.read(pc + 1) | cpu.read(last) << 8) == pc;
+}
+
+// Passes the time a JMP to itself spins until the next event or the end of the slice in
+// one go, in whole 3 cycle JMPs so the event is due at the same instruction it would be.
+void skip_to_event(Dodgy6502 &cpu, unsigned long long end){
+    unsigned long long until = cpu.events.front().at < end ? cpu.events.front().at : end;
+    if(until > cpu.cycles)
+        cpu.cycles += (until - cpu.cycles + 2) / 3 * 3;
+}
+
+}
+
+Fleet::Fleet(unsigned int threads){
+    if(!threads)
+        threads = std::thread::hardware_concurrency();
+    if(!threads)
+        threads = 1;
+    for(unsigned int i = 0; i < threads; i++)
+        this->threads.emplace_back(&Fleet::work, this);
+}
+
+Fleet::~Fleet(){
+    {
+        std::lock_guard<std::mutex> hold(lock);
+        stopping = true;
+    }
+    work_ready.notify_all();
+    for(std::thread &thread : threads)
+        thread.join();
+}
+
+unsigned int Fleet::add(Dodgy6502 &cpu, unsigned long long quantum, unsigned int idle_pc){
+    if(!quantum)
+        throw std::runtime_error("Fleet: a quantum of 0 cycles");
+    std::lock_guard<std::mutex> hold(lock);
+    instances.emplace_back();
+    Instance &instance = instances.back();
+    instance.cpu = &cpu;
+    instance.quantum = quantum;
+    instance.idle_pc = idle_pc;
+    return instances.size() - 1;
+}
+
+// with the lock held
+void Fleet::queue(Instance &instance){
+    if(instance.state == Instance::RUNNING)
+        instance.woken = true;
+    else if(instance.state == Instance::PARKED && instance.quota){
+        instance.state = Instance::QUEUED;
+        instance.stop = Dodgy6502::STOP_NONE;
+        ready.push_back(&instance);
+        work_ready.notify_one();
+    }
+}
+
+void Fleet::wake(unsigned int id){
+    std::lock_guard<std::mutex> hold(lock);
+    queue(instances.at(id));
+}
+
+void Fleet::post(unsigned int id, std::function<void(Dodgy6502 &cpu)> work){
+    std::lock_guard<std::mutex> hold(lock);
+    Instance &instance = instances.at(id);
+    instance.mail.push_back(std::move(work));
+    queue(instance);
+}
+
+void Fleet::set_quota(unsigned int id, unsigned long long cycles){
+    std::lock_guard<std::mutex> hold(lock);
+    instances.at(id).quota = cycles;
+}
+
+void Fleet::grant(unsigned int id, unsigned long long cycles){
+    std::lock_guard<std::mutex> hold(lock);
+    Instance &instance = instances.at(id);
+    instance.quota = cycles > ~0ull - instance.quota ? ~0ull : instance.quota + cycles;
+    queue(instance);
+}
+
+void Fleet::wait_idle(){
+    std::unique_lock<std::mutex> hold(lock);
+    all_parked.wait(hold, [this]{ return ready.empty() && !running; });
+}
+
+Dodgy6502::STOPS6502 Fleet::parked(unsigned int id){
+    std::lock_guard<std::mutex> hold(lock);
+    const Instance &instance = instances.at(id);
+    return instance.state == Instance::PARKED ? instance.stop : Dodgy6502::STOP_NONE;
+}
+
+unsigned long long Fleet::quota(unsigned int id){
+    std::lock_guard<std::mutex> hold(lock);
+    return instances.at(id).quota;
+}
+
+// Mail that arrives during a slice, or a wake up, queues the instance again instead of
+// letting it park. An instance out of quota parks regardless and keeps its mail.
+void Fleet::work(){
+    std::unique_lock<std::mutex> hold(lock);
+    for(;;){
+        work_ready.wait(hold, [this]{ return stopping || !ready.empty(); });
+        if(stopping)
+            return;
+        Instance &instance = *ready.front();
+        ready.pop_front();
+        instance.state = Instance::RUNNING;
+        instance.woken = false;
+        std::vector<std::function<void(Dodgy6502 &cpu)>> mail;
+        mail.swap(instance.mail);
+        unsigned long long slice = instance.quantum < instance.quota ? instance.quantum : instance.quota;
+        running++;
+        hold.unlock();
+
+        Dodgy6502 &cpu = *instance.cpu;
+        for(auto &work : mail)
+            work(cpu);
+        unsigned long long start = cpu.cycles;
+        Dodgy6502::STOPS6502 stop = Dodgy6502::STOP_NONE;
+        if(cpu.pc == instance.idle_pc)
+            stop = cpu.step(); // leaves the idle pc, a poll loop polls once per wake up
+        // with an event pending an idle instance is waiting for it, not for the host, and
+        // keeps running: time only passes in its slices
+        unsigned int until = cpu.events.empty() ? instance.idle_pc : NO_STOP_PC;
+        if(stop == Dodgy6502::STOP_NONE && !cpu.events.empty() && !cpu.interrupts && jumps_to_itself(cpu))
+            skip_to_event(cpu, start + slice);
+        if(stop == Dodgy6502::STOP_NONE)
+            stop = cpu.run_engine(slice > cpu.cycles - start ? slice - (cpu.cycles - start) : 1, until);
+        if(stop == Dodgy6502::STOP_CYCLES && cpu.events.empty() && jumps_to_itself(cpu))
+            stop = Dodgy6502::STOP_PC;
+        unsigned long long used = cpu.cycles - start;
+
+        hold.lock();
+        running--;
+        if(instance.quota != ~0ull)
+            instance.quota -= used < instance.quota ? used : instance.quota;
+        bool idle = stop != Dodgy6502::STOP_CYCLES && !instance.woken && instance.mail.empty();
+        if(!instance.quota || idle){
+            instance.state = Instance::PARKED;
+            instance.stop = stop;
+        }
+        else{
+            instance.state = Instance::QUEUED;
+            ready.push_back(&instance);
+        }
+        if(ready.empty() && !running)
+            all_parked.notify_all();
+    }
+}
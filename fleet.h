@@ -0,0 +1,52 @@
+#pragma once
+#include "6502v2.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Time slices many long lived CPUs on a few host threads, see fleet.cpp. A CPU belongs
+// to the fleet from add() on: other threads reach it only through post(), whose work runs
+// on the thread of its next slice. CPUs start parked, wake() one once it is set up.
+class Fleet {
+public:
+    explicit Fleet(unsigned int threads = 0); // 0 uses every hardware thread
+    ~Fleet(); // lets the running slices finish, the CPUs keep their state
+
+    // `quantum` cycles per slice. An instance reaching `idle_pc` parks there, give it the
+    // loop that polls for I/O and post() or wake() the instance when the I/O arrives.
+    unsigned int add(Dodgy6502 &cpu, unsigned long long quantum = 10000, unsigned int idle_pc = NO_STOP_PC);
+    void wake(unsigned int id);
+    void post(unsigned int id, std::function<void(Dodgy6502 &cpu)> work); // wakes it too
+    void set_quota(unsigned int id, unsigned long long cycles); // an instance out of quota parks, ~0 is no limit
+    void grant(unsigned int id, unsigned long long cycles); // adds to the quota and wakes it
+    void wait_idle(); // until every instance is parked
+
+    // why an instance parked: STOP_PC idle, STOP_CYCLES out of quota, or the halt it ran
+    // into. STOP_NONE while it is queued or running.
+    Dodgy6502::STOPS6502 parked(unsigned int id);
+    unsigned long long quota(unsigned int id);
+
+private:
+    struct Instance {
+        Dodgy6502* cpu;
+        unsigned long long quantum;
+        unsigned long long quota = ~0ull;
+        unsigned int idle_pc;
+        enum { PARKED, QUEUED, RUNNING } state = PARKED;
+        bool woken = false; // while running, so it is queued again instead of parked
+        Dodgy6502::STOPS6502 stop = Dodgy6502::STOP_NONE;
+        std::vector<std::function<void(Dodgy6502 &cpu)>> mail;
+    };
+    std::deque<Instance> instances;
+    std::deque<Instance*> ready;
+    unsigned int running = 0;
+    bool stopping = false;
+    std::mutex lock;
+    std::condition_variable work_ready, all_parked;
+    std::vector<std::thread> threads;
+    void queue(Instance &instance);
+    void work();
+};
@@ -0,0 +1,207 @@
+# include "fuzz.h"
+# include "console.h"
+# include "dispatch.h"
+# include <cstdio>
+# include <cstdlib>
+# include <cstring>
+# include <stdexcept>
+# include <string>
+# include <unistd.h>
+# include <sys/shm.h>
+# include <sys/wait.h>
+
+// Inputs run on the switch core instantiated with EdgeCoverage, the only loop that carries
+// instrumentation. Every run restores the snapshot taken before the first one, which
+// only copies back the pages the last input dirtied, so a run costs about as much as the
+// code it executes. A run ends on the budget or a halting opcode, JAM and undocumented
+// opcodes count as crashes: firmware gets there by jumping into data.
+
+byte FuzzInput::read(word address){
+    if(address & 1)
+        return (position < size ? Console::INPUT_READY : 0) | Console::OUTPUT_READY;
+    return position < size ? data[position++] : 0;
+}
+
+void FuzzInput::write(word, byte){
+}
+
+FuzzTarget::FuzzTarget(Dodgy6502 &cpu, unsigned long long budget, byte* map)
+        : map(map), cpu(cpu), budget(budget){
+    if(!map){
+        own_map.resize(FUZZ_MAP_SIZE);
+        this->map = own_map.data();
+    }
+}
+
+void FuzzTarget::input_to_memory(word address, unsigned int max_size){
+    if(cpu.dma_reaches_device(address, max_size, true))
+        throw std::runtime_error("Fuzz input range reaches a device page or wraps past $FFFF");
+    input_address = address;
+    input_max = max_size;
+}
+
+void FuzzTarget::input_to_console(byte page){
+    cpu.map_device(page, 1, &console);
+}
+
+bool FuzzTarget::crashed(Dodgy6502::STOPS6502 stop){
+    return stop == Dodgy6502::STOP_JAM || stop == Dodgy6502::STOP_INVALID;
+}
+
+void FuzzTarget::prepare(){
+    if(!started)
+        cpu.snapshot(start);
+    started = true;
+}
+
+// run_engine() with the instrumented loop, interrupts count as edges too
+Dodgy6502::STOPS6502 FuzzTarget::run(const byte* data, size_t size){
+    if(started)
+        cpu.restore(start);
+    else
+        prepare();
+    // checked when the input was placed, the snapshot brings that mapping back
+    if(input_max && !cpu.dma_write(input_address, data, size < input_max ? size : input_max))
+        throw std::runtime_error("Fuzz input range reaches a device page");
+    console.data = data;
+    console.size = size;
+    console.position = 0;
+
+    EdgeCoverage coverage{map};
+    unsigned long long end = budget > ~0ull - cpu.cycles ? ~0ull : cpu.cycles + budget;
+    for(;;){
+        if(cpu.interrupts){
+            word from = cpu.pc;
+            cpu.take_interrupts();
+            if(cpu.pc != from)
+                coverage.edge(from, cpu.pc);
+        }
+        cpu.deadline = cpu.events.empty() || cpu.events.front().at > end ? end : cpu.events.front().at;
+        Dodgy6502::STOPS6502 stop = switch_loop(cpu, NO_STOP_PC, coverage);
+        if(!cpu.events.empty() && cpu.events.front().at <= cpu.cycles)
+            cpu.dispatch_events();
+        if(stop != Dodgy6502::STOP_CYCLES || cpu.cycles >= end)
+            return stop;
+    }
+}
+
+FuzzTarget& fuzz_setup(char* const args[], byte* map){
+    static Dodgy6502 cpu;
+    word base = parse_number(args[1], 16, 0xffff);
+    word start = parse_number(args[2], 16, 0xffff);
+    unsigned long long budget = parse_number(args[3], 10, ~0ull);
+    std::string input = args[4];
+    word address = 0;
+    unsigned int size = 0;
+    if(input != "console"){
+        size_t colon = input.find(':');
+        address = parse_number(input.substr(0, colon).c_str(), 16, 0xffff);
+        size = colon == std::string::npos ? 0x10000 - address
+                                          : parse_number(input.substr(colon + 1).c_str(), 16, 0x10000 - address);
+    }
+    cpu.load_rom(args[0], base);
+    cpu.pc = start;
+    static FuzzTarget target(cpu, budget, map);
+    if(input == "console")
+        target.input_to_console(0xf0);
+    else
+        target.input_to_memory(address, size);
+    return target;
+}
+
+byte* afl_map(){
+    const char* id = getenv("__AFL_SHM_ID");
+    if(!id)
+        return nullptr;
+    void* map = shmat(atoi(id), nullptr, 0);
+    return map == (void*)-1 ? nullptr : (byte*)map;
+}
+
+// AFL's fork server protocol: a hello on the status pipe, then for every input a go
+// on the control pipe, answered with the pid of a fresh child and its exit status.
+// The child leaves the loop and runs the input. Without AFL the hello fails.
+static const int AFL_CONTROL_FD = 198;
+static const int AFL_STATUS_FD = AFL_CONTROL_FD + 1;
+
+static void afl_fork_server(){
+    int message = 0;
+    if(write(AFL_STATUS_FD, &message, 4) != 4)
+        return;
+    for(;;){
+        if(read(AFL_CONTROL_FD, &message, 4) != 4)
+            _exit(0);
+        pid_t child = fork();
+        if(child < 0)
+            _exit(1);
+        if(!child){
+            close(AFL_CONTROL_FD);
+            close(AFL_STATUS_FD);
+            return;
+        }
+        int status;
+        if(write(AFL_STATUS_FD, &child, 4) != 4 || waitpid(child, &status, 0) < 0 ||
+           write(AFL_STATUS_FD, &status, 4) != 4)
+            _exit(1);
+    }
+}
+
+// the children start from the snapshot taken before the fork instead of each taking it
+int fuzz_afl(FuzzTarget &target, const char* filename){
+    target.prepare();
+    afl_fork_server();
+    FILE* file = filename ? fopen(filename, "rb") : stdin;
+    if(!file){
+        perror(filename);
+        return 1;
+    }
+    std::vector<byte> input;
+    byte buffer[4096];
+    size_t count;
+    while((count = fread(buffer, 1, sizeof buffer, file)) > 0)
+        input.insert(input.end(), buffer, buffer + count);
+    if(filename)
+        fclose(file);
+    if(FuzzTarget::crashed(target.run(input.data(), input.size())))
+        abort();
+    return 0;
+}
+
+#ifdef DODGY6502_LIBFUZZER
+// libFuzzer owns main() and its arguments, the target is set up from the environment:
+// DODGY6502_FUZZ="image load start budget input" as for --fuzz. The map lives in the
+// section libFuzzer reads extra counters from, the emulator itself is not instrumented.
+__attribute__((section("__libfuzzer_extra_counters"))) static byte libfuzzer_map[FUZZ_MAP_SIZE];
+
+extern "C" int LLVMFuzzerTestOneInput(const byte* data, size_t size){
+    static FuzzTarget* target = nullptr;
+    if(!target){
+        const char* setup = getenv("DODGY6502_FUZZ");
+        if(!setup){
+            fprintf(stderr, "DODGY6502_FUZZ=\"image load start budget input\" is not set\n");
+            exit(1);
+        }
+        static std::string words = setup;
+        std::vector<char*> args;
+        for(char* arg = strtok(&words[0], " "); arg; arg = strtok(nullptr, " "))
+            args.push_back(arg);
+        if(args.size() < 5){
+            fprintf(stderr, "DODGY6502_FUZZ needs image load start budget input\n");
+            exit(1);
+        }
+        try{
+            target = &fuzz_setup(args.data(), libfuzzer_map);
+        }
+        catch(const std::invalid_argument &bad){
+            fprintf(stderr, "DODGY6502_FUZZ: bad argument %s\n", bad.what());
+            exit(1);
+        }
+        catch(const std::runtime_error &error){
+            fprintf(stderr, "DODGY6502_FUZZ: %s\n", error.what());
+            exit(1);
+        }
+    }
+    if(FuzzTarget::crashed(target->run(data, size)))
+        abort();
+    return 0;
+}
+#endif
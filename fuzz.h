@@ -0,0 +1,61 @@
+#pragma once
+#include "6502v2.h"
+#include <vector>
+
+#define FUZZ_MAP_SIZE 0x10000 // counters in a coverage map, AFL's default
+
+// AFL style edge coverage for switch_loop(): a control transfer bumps the counter picked
+// by the hashed addresses of both of its ends, wrapping like AFL's counters.
+struct EdgeCoverage {
+    byte* map;
+    static word scatter(word pc){ return (word)(pc * 0x9e37u) ^ pc >> 8; }
+    void edge(word from, word to){
+        map[(word)(scatter(from) >> 1 ^ scatter(to))]++;
+    }
+};
+
+// Serves the fuzz input through the registers of Console, so firmware that reads its
+// input from the console reads the fuzz input and sees no input once it is used up.
+// Output is dropped.
+class FuzzInput : public BusDevice {
+public:
+    byte read(word address) override;
+    void write(word address, byte data) override;
+    const byte* data = nullptr;
+    size_t size = 0, position = 0;
+};
+
+// Runs the CPU once per input, see fuzz.cpp. Set the CPU up first, load the firmware,
+// map devices and set pc, then choose where the input goes. prepare(), or else the first
+// run, snapshots that state and every run starts from it.
+class FuzzTarget {
+public:
+    FuzzTarget(Dodgy6502 &cpu, unsigned long long budget, byte* map = nullptr); // FUZZ_MAP_SIZE counters, the target's own if null
+    void input_to_memory(word address, unsigned int max_size); // longer inputs are cut off, throws if the range reaches a device page
+    void input_to_console(byte page); // maps a FuzzInput there
+    void prepare(); // takes the snapshot, before forking for example
+    Dodgy6502::STOPS6502 run(const byte* data, size_t size);
+    static bool crashed(Dodgy6502::STOPS6502 stop); // jammed or hit an undocumented opcode
+    byte* map;
+
+private:
+    Dodgy6502 &cpu;
+    unsigned long long budget;
+    Snapshot start;
+    bool started = false;
+    word input_address = 0;
+    unsigned int input_max = 0;
+    FuzzInput console;
+    std::vector<byte> own_map;
+};
+
+// AFL front end: the coverage map is the shared memory AFL names in __AFL_SHM_ID, nullptr
+// without it. fuzz_afl() runs the input from `filename` or stdin and aborts on a crash,
+// started by AFL as a fork server it forks a child per input from the set up CPU.
+byte* afl_map();
+int fuzz_afl(FuzzTarget &target, const char* filename);
+
+// sets up a target from `image load start budget input`, the arguments of --fuzz: input
+// is "console" for a FuzzInput at $F000 or a hex address with an optional :hex size.
+// Throws std::invalid_argument for a malformed argument.
+FuzzTarget& fuzz_setup(char* const args[], byte* map);
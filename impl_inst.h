@@ -0,0 +1,495 @@
+#pragma once
+// included at the end of 6502v2.h so every engine can inline the instructions
+
+# define NEGATIVE(_a) ((_a) & 0x80)
+# define ZERO(_a) ((_a) == 0)
+
+// Instructions that read their operand return 1 to take the extra cycle of an indexed
+// mode crossing a page, branches return the cycles a taken branch adds.
+
+// taken branch, one extra cycle and another one if it lands on a different page
+inline byte Dodgy6502::branch() {
+    word target = pc + (signed char)fetched;
+    byte extra = 1 + ((target ^ pc) >> 8 != 0);
+    pc = target;
+    return extra;
+}
+
+// Arithmetic kernels of ADC and SBC. Only the D flag branches, the rest compiles to
+// straight-line code. Decimal mode follows the NMOS chip: N and V are taken from the
+// result before the high nibble is adjusted and Z from the binary sum, SBC sets all
+// flags like in binary mode.
+
+inline void Dodgy6502::add_binary(byte value) {
+    word sum = a + value + (flag_c & C);
+    flag_v = (a ^ sum) & (value ^ sum) & 0x80; // both operands differ in sign from the sum
+    flag_c = sum >> 8;
+    a = sum;
+    set_nz(a);
+}
+
+inline void Dodgy6502::add_decimal(byte value) {
+    byte carry = flag_c & C;
+    word low = (a & 0x0f) + (value & 0x0f) + carry;
+    word sum = (a & 0xf0) + (value & 0xf0) + (low > 0x09 ? ((low + 0x06) & 0x0f) + 0x10 : low);
+    flag_z = a + value + carry;
+    flag_n = sum;
+    flag_v = (a ^ sum) & ~(a ^ value) & 0x80;
+    sum += sum > 0x9f ? 0x60 : 0;
+    flag_c = sum > 0xff;
+    a = sum;
+}
+
+inline void Dodgy6502::subtract_decimal(byte value) {
+    byte borrow = ~flag_c & C;
+    word low = (a & 0x0f) - (value & 0x0f) - borrow;
+    word difference = low & 0x10 ? ((low - 0x06) & 0x0f) | ((a & 0xf0) - (value & 0xf0) - 0x10)
+                                 : (low & 0x0f) | ((a & 0xf0) - (value & 0xf0));
+    difference -= difference & 0x100 ? 0x60 : 0;
+    add_binary(~value);
+    a = difference;
+}
+
+// add with carry
+inline byte Dodgy6502::ADC() {
+    if(sb & D)
+        add_decimal(fetched);
+    else
+        add_binary(fetched);
+    return 1;
+}
+
+// and (with accumulator)
+inline byte Dodgy6502::AND() {
+    a &= fetched;
+    set_nz(a);
+    return 1;
+}
+
+// arithmetic shift left
+inline byte Dodgy6502::ASL() {
+    set_flag(FLAGS6502::C, NEGATIVE(fetched));
+    fetched <<= 1;
+    set_nz(fetched);
+    write(abs_addr, fetched);
+    return 0;
+}
+
+inline byte Dodgy6502::ASL_A() {
+    set_flag(FLAGS6502::C, NEGATIVE(a));
+    a <<= 1;
+    set_nz(a);
+    return 0;
+}
+
+// branch on carry clear
+inline byte Dodgy6502::BCC() {
+    if(!read_flag(FLAGS6502::C))
+        return branch();
+    return 0;
+}
+
+// branch on carry set
+inline byte Dodgy6502::BCS() {
+    if(read_flag(FLAGS6502::C))
+        return branch();
+    return 0;
+}
+
+// branch on equal (zero set)
+inline byte Dodgy6502::BEQ() {
+    if(read_flag(FLAGS6502::Z))
+        return branch();
+    return 0;
+}
+
+// bit test
+inline byte Dodgy6502::BIT() {
+    set_flag(FLAGS6502::V, fetched & (1 << 6));
+    flag_n = fetched; // N is bit 7 of the operand
+    flag_z = fetched & a;
+    return 0;
+}
+
+// branch on minus (negative set)
+inline byte Dodgy6502::BMI() {
+    if(read_flag(FLAGS6502::N))
+        return branch();
+    return 0;
+}
+
+// branch on not equal (zero clear)
+inline byte Dodgy6502::BNE() {
+    if(!read_flag(FLAGS6502::Z))
+        return branch();
+    return 0;
+}
+
+// branch on plus (negative clear)
+inline byte Dodgy6502::BPL() {
+    if(!read_flag(FLAGS6502::N))
+        return branch();
+    return 0;
+}
+
+// break / interrupt, halts the run with pc on the BRK
+inline byte Dodgy6502::BRK() {
+    pc--;
+    halt = STOP_BRK;
+    return 0;
+}
+
+// branch on overflow clear
+inline byte Dodgy6502::BVC() {
+    if(!read_flag(FLAGS6502::V))
+        return branch();
+    return 0;
+}
+
+// branch on overflow set
+inline byte Dodgy6502::BVS() {
+    if(read_flag(FLAGS6502::V))
+        return branch();
+    return 0;
+}
+
+// clear carry
+inline byte Dodgy6502::CLC() {
+    set_flag(FLAGS6502::C, false);
+    return 0;
+}
+
+// clear decimal
+inline byte Dodgy6502::CLD() {
+    set_flag(FLAGS6502::D, false);
+    return 0;
+}
+
+// clear interrupt disable
+inline byte Dodgy6502::CLI() {
+    set_flag(FLAGS6502::I, false);
+    irq_unmasked();
+    return 0;
+}
+
+// clear overflow
+inline byte Dodgy6502::CLV() {
+    set_flag(FLAGS6502::V, false);
+    return 0;
+}
+
+// compare (with accumulator)
+inline byte Dodgy6502::CMP() {  // TODO CRITICAL: UNSIGNED FLAG SETTING
+    temp = a - fetched;
+    set_nz(temp);
+    set_flag(FLAGS6502::C, a >= fetched);
+    return 1;
+}
+
+// compare with X
+inline byte Dodgy6502::CPX() {
+    temp = x - fetched;
+    set_nz(temp);
+    set_flag(FLAGS6502::C, x >= fetched);
+    return 0;
+}
+
+// compare with Y
+inline byte Dodgy6502::CPY() {
+    temp = y - fetched;
+    set_nz(temp);
+    set_flag(FLAGS6502::C, y >= fetched);
+    return 0;
+}
+
+// decrement
+inline byte Dodgy6502::DEC() {
+    write(abs_addr, --fetched);
+    set_nz(fetched);
+    return 0;
+}
+
+// decrement X
+inline byte Dodgy6502::DEX() {
+    x--;
+    set_nz(x);
+    return 0;
+}
+
+// decrement Y
+inline byte Dodgy6502::DEY() {
+    y--;
+    set_nz(y);
+    return 0;
+}
+
+// exclusive or (with accumulator)
+inline byte Dodgy6502::EOR() {
+    a ^= fetched;
+    set_nz(a);
+    return 1;
+}
+
+// increment
+inline byte Dodgy6502::INC() {
+    write(abs_addr, ++fetched);
+    set_nz(fetched);
+    return 0;
+}
+
+// increment X
+inline byte Dodgy6502::INX() {
+    x++;
+    set_nz(x);
+    return 0;
+}
+
+// increment Y
+inline byte Dodgy6502::INY() {
+    y++;
+    set_nz(y);
+    return 0;
+}
+
+// jump
+inline byte Dodgy6502::JMP() {
+    pc = abs_addr;
+    return 0;
+}
+
+// jump subroutine
+inline byte Dodgy6502::JSR() {
+    pc--; // pushes the address of the last operand byte
+    push(pc >> 8);
+    push(pc & 0xFF);
+    pc = abs_addr;
+    return 0;
+}
+
+// load accumulator
+inline byte Dodgy6502::LDA() {
+    a = fetched;
+    set_nz(a);
+    return 1;
+}
+
+// load X
+inline byte Dodgy6502::LDX() {
+    x = fetched;
+    set_nz(x);
+    return 1;
+}
+
+// load Y
+inline byte Dodgy6502::LDY() {
+    y = fetched;
+    set_nz(y);
+    return 1;
+}
+
+// logical shift right
+inline byte Dodgy6502::LSR() {
+    set_flag(FLAGS6502::C, fetched & 0x1);
+    fetched >>= 1;
+    set_nz(fetched); // bit 7 was shifted out, N is clear
+    write(abs_addr, fetched);
+    return 0;
+}
+
+inline byte Dodgy6502::LSR_A() {
+    set_flag(FLAGS6502::C, a & 0x1);
+    a >>= 1;
+    set_nz(a); // bit 7 was shifted out, N is clear
+    return 0;
+}
+
+// no operation
+inline byte Dodgy6502::NOP() {
+    return 0;
+}
+
+// or with accumulator
+inline byte Dodgy6502::ORA() {
+    a |= fetched;
+    set_nz(a);
+    return 1;
+}
+
+// push accumulator
+inline byte Dodgy6502::PHA() {
+    push(a);
+    return 0;
+}
+
+// push processor status (SR)
+inline byte Dodgy6502::PHP() {
+    push(status());
+    return 0;
+}
+
+// pull accumulator
+inline byte Dodgy6502::PLA() {
+    a = pop();
+    set_nz(a);
+    return 0;
+}
+
+// pull processor status (SR)
+inline byte Dodgy6502::PLP() {
+    set_status(pop());
+    irq_unmasked();
+    return 0;
+}
+
+// rotate left
+inline byte Dodgy6502::ROL() {
+    temp = NEGATIVE(fetched);
+    fetched = (fetched << 1) | read_flag(FLAGS6502::C);
+    set_flag(FLAGS6502::C, temp);
+    set_nz(fetched);
+    write(abs_addr, fetched);
+    return 0;
+}
+
+inline byte Dodgy6502::ROL_A() {
+    temp = NEGATIVE(a);
+    a = (a << 1) | read_flag(FLAGS6502::C);
+    set_flag(FLAGS6502::C, temp);
+    set_nz(a);
+    return 0;
+}
+
+// rotate right
+inline byte Dodgy6502::ROR() {
+    temp = fetched & 0x1;
+    fetched = (fetched >> 1) | (read_flag(FLAGS6502::C) << 7);
+    set_flag(FLAGS6502::C, temp);
+    set_nz(fetched);
+    write(abs_addr, fetched);
+    return 0;
+}
+
+inline byte Dodgy6502::ROR_A() {
+    temp = a & 0x1;
+    a = (a >> 1) | (read_flag(FLAGS6502::C) << 7);
+    set_flag(FLAGS6502::C, temp);
+    set_nz(a);
+    return 0;
+}
+
+// return from interrupt
+inline byte Dodgy6502::RTI() {
+    set_status(pop());
+    pc = pop();
+    pc |= pop() << 8;
+    irq_unmasked();
+    return 0;
+}
+
+// return from subroutine
+inline byte Dodgy6502::RTS() {
+    pc = pop();
+    pc |= pop() << 8;
+    pc++;
+    return 0;
+}
+
+// subtract with carry, in binary mode the same as adding the one's complement
+inline byte Dodgy6502::SBC() {
+    if(sb & D)
+        subtract_decimal(fetched);
+    else
+        add_binary(~fetched);
+    return 1;
+}
+
+// set carry
+inline byte Dodgy6502::SEC() {
+    set_flag(FLAGS6502::C, true);
+    return 0;
+}
+
+// set decimal
+inline byte Dodgy6502::SED() {
+    set_flag(FLAGS6502::D, true);
+    return 0;
+}
+
+// set interrupt disable
+inline byte Dodgy6502::SEI() {
+    set_flag(FLAGS6502::I, true);
+    return 0;
+}
+
+// store accumulator
+inline byte Dodgy6502::STA() {
+    write(abs_addr, a);
+    return 0;
+}
+
+// store X
+inline byte Dodgy6502::STX() {
+    write(abs_addr, x);
+    return 0;
+}
+
+// store Y
+inline byte Dodgy6502::STY() {
+    write(abs_addr, y);
+    return 0;
+}
+
+// transfer accumulator to X
+inline byte Dodgy6502::TAX() {
+    x = a;
+    set_nz(x);
+    return 0;
+}
+
+// transfer accumulator to Y
+inline byte Dodgy6502::TAY() {
+    y = a;
+    set_nz(y);
+    return 0;
+}
+
+// transfer stack pointer to X
+inline byte Dodgy6502::TSX() {
+    x = sp;
+    set_nz(x);
+    return 0;
+}
+
+// transfer X to accumulator
+inline byte Dodgy6502::TXA() {
+    a = x;
+    set_nz(a);
+    return 0;
+}
+
+// transfer X to stack pointer
+inline byte Dodgy6502::TXS() {
+    sp = x;
+    return 0;
+}
+
+// transfer Y to accumulator
+inline byte Dodgy6502::TYA() {
+    a = y;
+    set_nz(a);
+    return 0;
+}
+
+// KIL, locks up the CPU with pc on the opcode
+inline byte Dodgy6502::JAM() {
+    pc--;
+    halt = STOP_JAM;
+    return 0;
+}
+
+// undocumented opcode, halts with pc on the opcode
+inline byte Dodgy6502::ILL() {
+    pc--;
+    halt = STOP_INVALID;
+    return 0;
+}
@@ -0,0 +1,529 @@
+# include "dispatch.h"
+
+// The JIT compiles code executed JIT_THRESHOLD times into x86-64 blocks. A, X, Y, SP
+// and the packed status register live in host registers for the whole block and are
+// written back to the Dodgy6502 members when the block exits. Only the instructions
+// handled in JitCompiler::instruction() are translated, a block ends in front of the first
+// one that is not and the interpreter carries on from there. Blocks never cross a page and
+// are dropped through invalidate_code() like the other caches. A store to a page holding
+// cached code leaves the block in front of the store, so the interpreter does the write
+// and the invalidation. Accesses outside the zero page and the stack look their page up
+// in the bus page table when the block runs, so remapping never leaves stale native code
+// behind, and a device page side exits to the interpreter. Every exit adds the cycles of
+// the instructions executed up to it to Dodgy6502::cycles, the engine checks its budget
+// between blocks.
+//
+// The code region is writable only while compile() writes to it and executable otherwise.
+// A block ends early when the region has no room left for another instruction, the next
+// block starts the region over.
+
+#if defined(__x86_64__) && defined(__unix__)
+
+# include <sys/mman.h>
+
+#define JIT_THRESHOLD 8
+#define JIT_CODE_SIZE (1 << 20)
+#define JIT_BLOCK_ROOM 4096 // bytes left in the region to start a block in
+#define JIT_MAX_INSTRUCTION 256 // bytes one instruction emits at most, its side exits included
+#define JIT_SIDE_EXIT 32 // bytes of one side exit in the epilogue
+#define JIT_BLOCK_END 96 // bytes of the exit closing a block and the shared exit
+#define JIT_UNCOMPILABLE 0xff
+
+typedef void(*JitBlock)(Dodgy6502 *cpu);
+
+struct JitPage {
+    JitBlock code[256] = {};
+    byte hits[256] = {};
+};
+
+struct JitCache {
+    byte* code = nullptr; // executable region
+    size_t used = 0;
+    JitPage* pages[256] = {};
+};
+
+// host registers, the 6502 registers are kept zero extended in the low byte
+enum HostRegister { RAX = 0, RCX = 1, RDX = 2, RSI = 6, RDI = 7, R8 = 8, R9 = 9, R10 = 10, R11 = 11 };
+static const int REG_CPU = RDI, REG_MEM = RSI, REG_P = RDX;
+static const int REG_A = R8, REG_X = R9, REG_Y = R10, REG_SP = R11;
+
+// x86 condition codes
+enum { CC_C = 0x2, CC_NC = 0x3, CC_Z = 0x4, CC_NZ = 0x5 };
+
+// Just the encodings the JIT uses. Memory operands are always [base + disp32] with a
+// base other than rsp/r12, the stack is [rsi + r11 + 0x100].
+class X64Emitter {
+public:
+    explicit X64Emitter(byte* start) : out(start) {}
+    byte* position() const { return out; }
+
+    void emit(byte b){ *out++ = b; }
+    void emit32(unsigned int v){ for(int i = 0; i < 4; i++) emit(v >> (8 * i)); }
+
+    void rex(bool w, int reg, int index, int base){
+        byte prefix = 0x40 | (w << 3) | ((reg >> 3) << 2) | ((index >> 3) << 1) | (base >> 3);
+        if(prefix != 0x40)
+            emit(prefix);
+    }
+    void modrm_reg(int reg, int rm){ emit(0xC0 | ((reg & 7) << 3) | (rm & 7)); }
+    void modrm_mem(int reg, int base, int disp){ emit(0x80 | ((reg & 7) << 3) | (base & 7)); emit32(disp); }
+    void modrm_stack(int reg){ emit(0x84 | ((reg & 7) << 3)); emit(((REG_SP & 7) << 3) | (REG_MEM & 7)); emit32(STACK_BASE); }
+
+    // op r/m, reg (8 or 32 bit depending on the opcode)
+    void op_rr(byte opcode, int rm, int reg){ rex(false, reg, 0, rm); emit(opcode); modrm_reg(reg, rm); }
+    // op reg, [base + disp]
+    void op_rm(byte opcode, int reg, int base, int disp){ rex(false, reg, 0, base); emit(opcode); modrm_mem(reg, base, disp); }
+    // group opcodes with a /digit, register operand
+    void group(byte opcode, int digit, int rm){ rex(false, 0, 0, rm); emit(opcode); modrm_reg(digit, rm); }
+    void group_imm8(byte opcode, int digit, int rm, byte imm){ group(opcode, digit, rm); emit(imm); }
+    // group opcodes with a /digit, memory operand
+    void group_mem(byte opcode, int digit, int base, int disp){ rex(false, 0, 0, base); emit(opcode); modrm_mem(digit, base, disp); }
+
+    void mov_imm(int reg, unsigned int imm){ rex(false, 0, 0, reg); emit(0xB8 | (reg & 7)); emit32(imm); }
+    void movzx_rr(int dst, int src){ rex(false, dst, 0, src); emit(0x0F); emit(0xB6); modrm_reg(dst, src); }
+    void load8(int reg, int base, int disp){ rex(false, reg, 0, base); emit(0x0F); emit(0xB6); modrm_mem(reg, base, disp); }
+    void store8(int reg, int base, int disp){ op_rm(0x88, reg, base, disp); }
+    void load_ptr(int reg, int base, int disp){ rex(true, reg, 0, base); emit(0x8B); modrm_mem(reg, base, disp); }
+    void test_ptr(int reg){ rex(true, reg, 0, reg); emit(0x85); modrm_reg(reg, reg); }
+    void store16(int reg, int base, int disp){ emit(0x66); op_rm(0x89, reg, base, disp); }
+    void store16_imm(int base, int disp, word imm){ emit(0x66); group_mem(0xC7, 0, base, disp); emit(imm); emit(imm >> 8); }
+    void add64_imm(int base, int disp, unsigned int imm){ rex(true, 0, 0, base); emit(0x81); modrm_mem(0, base, disp); emit32(imm); }
+    void load8_stack(int reg){ rex(false, reg, REG_SP, REG_MEM); emit(0x0F); emit(0xB6); modrm_stack(reg); }
+    void store8_stack(int reg){ rex(false, reg, REG_SP, REG_MEM); emit(0x88); modrm_stack(reg); }
+    void setcc(byte cc, int reg){ rex(false, 0, 0, reg); emit(0x0F); emit(0x90 | cc); modrm_reg(0, reg); }
+    void bt_imm(int reg, byte bit){ rex(false, 0, 0, reg); emit(0x0F); emit(0xBA); modrm_reg(4, reg); emit(bit); }
+    void ret(){ emit(0xC3); }
+
+    // jumps to labels bound later, return the address right behind the rel32
+    byte* jcc(byte cc){ emit(0x0F); emit(0x80 | cc); emit32(0); return out; }
+    byte* jmp(){ emit(0xE9); emit32(0); return out; }
+    static void bind(byte* after_jump, byte* target){
+        unsigned int rel = (unsigned int)(target - after_jump);
+        for(int i = 0; i < 4; i++) after_jump[i - 4] = rel >> (8 * i);
+    }
+
+private:
+    byte* out;
+};
+
+// alu opcodes, op r/m, reg form
+enum {
+    OP_ADD8 = 0x00, OP_OR8 = 0x08, OP_AND8 = 0x20, OP_SUB8 = 0x28, OP_XOR8 = 0x30,
+    OP_OR32 = 0x09, OP_MOV32 = 0x89, OP_TEST32 = 0x85,
+};
+
+class JitCompiler {
+public:
+    JitCompiler(Dodgy6502 &cpu, byte* start, byte* end) : cpu(cpu), e(start), end(end) {}
+
+    X64Emitter& emitter(){ return e; }
+
+    // room for one more instruction and everything that closes the block after it
+    bool room() const {
+        return e.position() + JIT_MAX_INSTRUCTION + side_exits.size() * JIT_SIDE_EXIT + JIT_BLOCK_END <= end;
+    }
+
+    void prologue(){
+        e.load_ptr(REG_MEM, REG_CPU, offset(&cpu.memory));
+        e.load8(REG_A, REG_CPU, offset(&cpu.a));
+        e.load8(REG_X, REG_CPU, offset(&cpu.x));
+        e.load8(REG_Y, REG_CPU, offset(&cpu.y));
+        e.load8(REG_SP, REG_CPU, offset(&cpu.sp));
+        e.load8(REG_P, REG_CPU, offset(&cpu.sb));
+    }
+
+    // side exits and the shared exit that writes the registers back
+    void epilogue(){
+        for(auto &side_exit : side_exits){
+            X64Emitter::bind(side_exit.jump, e.position());
+            count_cycles(side_exit.cycles);
+            e.store16_imm(REG_CPU, offset(&cpu.pc), side_exit.pc);
+            exits.push_back(e.jmp());
+        }
+        for(byte* exit : exits)
+            X64Emitter::bind(exit, e.position());
+        e.store8(REG_A, REG_CPU, offset(&cpu.a));
+        e.store8(REG_X, REG_CPU, offset(&cpu.x));
+        e.store8(REG_Y, REG_CPU, offset(&cpu.y));
+        e.store8(REG_SP, REG_CPU, offset(&cpu.sp));
+        e.store8(REG_P, REG_CPU, offset(&cpu.sb));
+        e.ret();
+    }
+
+    // leaves the block after the current instruction
+    void exit_to(word pc){
+        count_cycles(counted + current);
+        e.store16_imm(REG_CPU, offset(&cpu.pc), pc);
+        exits.push_back(e.jmp());
+    }
+
+    // emits one instruction, returns false if it is not supported
+    bool instruction(byte opcode, const DecodedInstruction &decoded, word pc, bool &ends){
+        bool supported = emit_instruction(opcode, decoded, pc, ends);
+        if(supported)
+            counted += current;
+        current = 0;
+        return supported;
+    }
+
+private:
+    Dodgy6502 &cpu;
+    X64Emitter e;
+    byte* end; // of the code region
+    struct SideExit {
+        byte* jump; // jump to patch
+        word pc; // pc to resume at
+        unsigned int cycles; // cycles of the instructions in front of it
+    };
+    std::vector<SideExit> side_exits;
+    std::vector<byte*> exits; // jumps to the shared exit, pc and cycles already stored
+    unsigned int counted = 0; // cycles of the instructions compiled so far
+    unsigned int current = 0; // cycles of the instruction being compiled
+
+    void count_cycles(unsigned int taken){
+        e.add64_imm(REG_CPU, offset(&cpu.cycles), taken);
+    }
+
+    bool emit_instruction(byte opcode, const DecodedInstruction &decoded, word pc, bool &ends);
+
+    int offset(const void* member) const { return (int)((const byte*)member - (const byte*)&cpu); }
+
+    // N and Z from the 8-bit value in `reg`, clobbers eax and ecx
+    void set_nz(int reg){
+        e.movzx_rr(RAX, reg);
+        e.group_imm8(0x83, 4, REG_P, 0x7D); // and edx, ~(N | Z)
+        e.op_rr(OP_TEST32, RAX, RAX);
+        e.setcc(CC_Z, RCX);
+        e.op_rr(OP_ADD8, RCX, RCX); // Z is bit 1
+        e.op_rr(OP_OR8, REG_P, RCX);
+        e.group_imm8(0x83, 4, RAX, 0x80); // keep N
+        e.op_rr(OP_OR32, REG_P, RAX);
+    }
+
+    // C from a host flag, has to directly follow the instruction producing it
+    void set_carry(byte cc){
+        e.setcc(cc, RCX);
+        e.movzx_rr(RCX, RCX);
+        e.group_imm8(0x83, 4, REG_P, 0xFE); // and edx, ~C
+        e.op_rr(OP_OR32, REG_P, RCX);
+    }
+
+    void push(int reg){
+        e.store8_stack(reg);
+        e.group(0xFE, 1, REG_SP); // dec r11b
+    }
+
+    void pull(int reg){
+        e.group(0xFE, 0, REG_SP); // inc r11b
+        e.load8_stack(reg);
+    }
+
+    // a write to a page with cached code has to go through write()
+    void guard_store(word address, word pc){
+        if(address < STACK_BASE + 0x100)
+            return; // zero page and stack are never cached
+        e.group_mem(0x80, 7, REG_CPU, offset(&cpu.code_pages[address >> 8]));
+        e.emit(0); // cmp byte [code_pages + page], 0
+        side_exits.push_back({e.jcc(CC_NZ), pc, counted});
+    }
+
+    // Base register for an access to `address`, to be used with page_offset(). Zero page
+    // and stack are always RAM at REG_MEM, other pages are loaded from the page table into
+    // `reg`, leaving the block in front of the instruction on a device page.
+    int page_base(word address, bool writes, word pc, int reg = RAX){
+        if(address < STACK_BASE + 0x100)
+            return REG_MEM;
+        const void* entry = writes ? (const void*)&cpu.write_pages[address >> 8] : (const void*)&cpu.read_pages[address >> 8];
+        e.load_ptr(reg, REG_CPU, offset(entry));
+        e.test_ptr(reg);
+        side_exits.push_back({e.jcc(CC_Z), pc, counted});
+        return reg;
+    }
+
+    static int page_offset(word address){
+        return address < STACK_BASE + 0x100 ? address : address & 0xff;
+    }
+
+    // value operand of a read instruction into ecx
+    bool operand(byte(Dodgy6502::*mode)(), word value, word pc){
+        if(mode == &Dodgy6502::imm)
+            e.mov_imm(RCX, value);
+        else if(mode == &Dodgy6502::zp || mode == &Dodgy6502::abs)
+            e.load8(RCX, page_base(value, false, pc), page_offset(value));
+        else
+            return false;
+        return true;
+    }
+};
+
+bool JitCompiler::emit_instruction(byte opcode, const DecodedInstruction &decoded, word pc, bool &ends){
+    byte(Dodgy6502::*mode)() = nullptr;
+    byte(Dodgy6502::*impl)() = nullptr;
+    switch(opcode){
+#define JIT_LOOKUP(opc, name, m, i, cycles, description) \
+        case opc: mode = &Dodgy6502::m; impl = &Dodgy6502::i; current = cycles; break;
+        DODGY6502_OPCODES(JIT_LOOKUP)
+#undef JIT_LOOKUP
+    }
+    word value = decoded.operand;
+    word next = pc + decoded.length;
+    bool direct = mode == &Dodgy6502::zp || mode == &Dodgy6502::abs;
+
+    if(impl == &Dodgy6502::LDA || impl == &Dodgy6502::LDX || impl == &Dodgy6502::LDY){
+        int reg = impl == &Dodgy6502::LDA ? REG_A : impl == &Dodgy6502::LDX ? REG_X : REG_Y;
+        if(mode == &Dodgy6502::imm) e.mov_imm(reg, value);
+        else if(direct) e.load8(reg, page_base(value, false, pc), page_offset(value));
+        else return false;
+        set_nz(reg);
+    }
+    else if(impl == &Dodgy6502::STA || impl == &Dodgy6502::STX || impl == &Dodgy6502::STY){
+        if(!direct) return false;
+        int base = page_base(value, true, pc);
+        guard_store(value, pc);
+        e.store8(impl == &Dodgy6502::STA ? REG_A : impl == &Dodgy6502::STX ? REG_X : REG_Y, base, page_offset(value));
+    }
+    else if(impl == &Dodgy6502::AND || impl == &Dodgy6502::ORA || impl == &Dodgy6502::EOR){
+        if(!operand(mode, value, pc)) return false;
+        e.op_rr(impl == &Dodgy6502::AND ? OP_AND8 : impl == &Dodgy6502::ORA ? OP_OR8 : OP_XOR8, REG_A, RCX);
+        set_nz(REG_A);
+    }
+    else if(impl == &Dodgy6502::CMP || impl == &Dodgy6502::CPX || impl == &Dodgy6502::CPY){
+        int reg = impl == &Dodgy6502::CMP ? REG_A : impl == &Dodgy6502::CPX ? REG_X : REG_Y;
+        if(!operand(mode, value, pc)) return false;
+        e.op_rr(OP_MOV32, RAX, reg);
+        e.op_rr(OP_SUB8, RAX, RCX); // al = reg - operand
+        set_carry(CC_NC); // no borrow: reg >= operand
+        set_nz(RAX);
+    }
+    else if(impl == &Dodgy6502::INX || impl == &Dodgy6502::INY || impl == &Dodgy6502::DEX || impl == &Dodgy6502::DEY){
+        int reg = impl == &Dodgy6502::INX || impl == &Dodgy6502::DEX ? REG_X : REG_Y;
+        e.group(0xFE, impl == &Dodgy6502::INX || impl == &Dodgy6502::INY ? 0 : 1, reg);
+        set_nz(reg);
+    }
+    else if(impl == &Dodgy6502::INC || impl == &Dodgy6502::DEC){
+        if(!direct) return false;
+        int source = page_base(value, false, pc, RAX);
+        int target = page_base(value, true, pc, RCX); // differs from source on ROM
+        guard_store(value, pc);
+        e.load8(RAX, source, page_offset(value));
+        e.group(0xFE, impl == &Dodgy6502::INC ? 0 : 1, RAX);
+        e.store8(RAX, target, page_offset(value));
+        set_nz(RAX);
+    }
+    else if(impl == &Dodgy6502::TAX || impl == &Dodgy6502::TAY || impl == &Dodgy6502::TXA ||
+            impl == &Dodgy6502::TYA || impl == &Dodgy6502::TSX){
+        int dst = impl == &Dodgy6502::TAX || impl == &Dodgy6502::TSX ? REG_X : impl == &Dodgy6502::TAY ? REG_Y : REG_A;
+        int src = impl == &Dodgy6502::TXA ? REG_X : impl == &Dodgy6502::TYA ? REG_Y : impl == &Dodgy6502::TSX ? REG_SP : REG_A;
+        e.op_rr(OP_MOV32, dst, src);
+        set_nz(dst);
+    }
+    else if(impl == &Dodgy6502::TXS){
+        e.op_rr(OP_MOV32, REG_SP, REG_X);
+    }
+    else if(impl == &Dodgy6502::ASL_A || impl == &Dodgy6502::LSR_A || impl == &Dodgy6502::ROL_A || impl == &Dodgy6502::ROR_A){
+        if(impl == &Dodgy6502::ROL_A || impl == &Dodgy6502::ROR_A)
+            e.bt_imm(REG_P, 0); // carry in
+        int digit = impl == &Dodgy6502::ASL_A ? 4 : impl == &Dodgy6502::LSR_A ? 5 : impl == &Dodgy6502::ROL_A ? 2 : 3;
+        e.group(0xD0, digit, REG_A); // shl/shr/rcl/rcr r8b, 1
+        set_carry(CC_C);
+        set_nz(REG_A);
+    }
+    else if(impl == &Dodgy6502::CLC || impl == &Dodgy6502::CLD || impl == &Dodgy6502::CLV){
+        byte flag = impl == &Dodgy6502::CLC ? Dodgy6502::C : impl == &Dodgy6502::CLD ? Dodgy6502::D : Dodgy6502::V;
+        e.group_imm8(0x83, 4, REG_P, ~flag);
+    }
+    else if(impl == &Dodgy6502::SEC || impl == &Dodgy6502::SED || impl == &Dodgy6502::SEI){
+        byte flag = impl == &Dodgy6502::SEC ? Dodgy6502::C : impl == &Dodgy6502::SED ? Dodgy6502::D : Dodgy6502::I;
+        e.group_imm8(0x83, 1, REG_P, flag);
+    }
+    else if(impl == &Dodgy6502::NOP){
+    }
+    else if(impl == &Dodgy6502::PHA || impl == &Dodgy6502::PHP){
+        push(impl == &Dodgy6502::PHA ? REG_A : REG_P);
+    }
+    else if(impl == &Dodgy6502::PLA){
+        pull(REG_A);
+        set_nz(REG_A);
+    }
+    else if(mode == &Dodgy6502::rel){
+        byte flag; bool set;
+        if(impl == &Dodgy6502::BPL || impl == &Dodgy6502::BMI){ flag = Dodgy6502::N; set = impl == &Dodgy6502::BMI; }
+        else if(impl == &Dodgy6502::BVC || impl == &Dodgy6502::BVS){ flag = Dodgy6502::V; set = impl == &Dodgy6502::BVS; }
+        else if(impl == &Dodgy6502::BCC || impl == &Dodgy6502::BCS){ flag = Dodgy6502::C; set = impl == &Dodgy6502::BCS; }
+        else { flag = Dodgy6502::Z; set = impl == &Dodgy6502::BEQ; }
+        e.group_imm8(0xF6, 0, REG_P, flag); // test dl, flag
+        byte* taken = e.jcc(set ? CC_NZ : CC_Z);
+        exit_to(next);
+        X64Emitter::bind(taken, e.position());
+        word target = next + (signed char)value;
+        current += 1 + ((target ^ next) >> 8 != 0); // taken, and to another page
+        exit_to(target);
+        ends = true;
+    }
+    else if(impl == &Dodgy6502::JMP && mode == &Dodgy6502::abs){
+        exit_to(value);
+        ends = true;
+    }
+    else if(impl == &Dodgy6502::JSR){
+        word ret = next - 1;
+        e.mov_imm(RAX, ret >> 8);
+        push(RAX);
+        e.mov_imm(RAX, ret & 0xff);
+        push(RAX);
+        exit_to(value);
+        ends = true;
+    }
+    else if(impl == &Dodgy6502::RTS){
+        pull(RAX);
+        pull(RCX);
+        e.group_imm8(0xC1, 4, RCX, 8); // shl ecx, 8
+        e.op_rr(OP_OR32, RAX, RCX);
+        e.group(0xFF, 0, RAX); // inc eax
+        e.store16(RAX, REG_CPU, offset(&cpu.pc));
+        count_cycles(counted + current);
+        exits.push_back(e.jmp());
+        ends = true;
+    }
+    else{
+        return false;
+    }
+    return true;
+}
+
+// the region is either writable or executable
+static bool protect(byte* code, bool writable){
+    return mprotect(code, JIT_CODE_SIZE, writable ? PROT_READ | PROT_WRITE : PROT_READ | PROT_EXEC) == 0;
+}
+
+bool Dodgy6502::compile(word address){
+    JitCache &cache = *jit;
+    if(cache.used + JIT_BLOCK_ROOM > JIT_CODE_SIZE){
+        // region full, start over
+        for(JitPage *page : cache.pages)
+            if(page) *page = JitPage();
+        cache.used = 0;
+    }
+    if(!protect(cache.code, true))
+        return false;
+
+    byte* start = cache.code + cache.used;
+    JitCompiler compiler(*this, start, cache.code + JIT_CODE_SIZE);
+    compiler.prologue();
+
+    byte page = address >> 8;
+    word pc = address;
+    int count = 0;
+    bool ends = false;
+    while(!ends && count < BLOCK_MAX_OPS && pc >> 8 == page && compiler.room()){
+        DecodedInstruction decoded;
+        if(!decode(pc, decoded))
+            break; // a device read, left to the interpreter
+        if((word)(pc + decoded.length - 1) >> 8 != page)
+            break; // stays inside the page
+        if(!compiler.instruction(read(pc), decoded, pc, ends))
+            break;
+        pc += decoded.length;
+        count++;
+    }
+    if(count){
+        if(!ends)
+            compiler.exit_to(pc);
+        compiler.epilogue();
+        cache.used += compiler.emitter().position() - start;
+    }
+    if(!protect(cache.code, false) || !count)
+        return false;
+    cache.pages[page]->code[address & 0xff] = (JitBlock)start;
+    return true;
+}
+
+void Dodgy6502::invalidate_jit(byte page){
+    if(jit && jit->pages[page])
+        *jit->pages[page] = JitPage();
+}
+
+void Dodgy6502::flush_jit(){
+    if(!jit)
+        return;
+    for(JitPage *page : jit->pages)
+        delete page;
+    if(jit->code)
+        munmap(jit->code, JIT_CODE_SIZE);
+    delete jit;
+    jit = nullptr;
+}
+
+DODGY_FLATTEN Dodgy6502::STOPS6502 Dodgy6502::run_jit(unsigned int until){
+    if(!jit){
+        jit = new JitCache;
+        void* code = mmap(nullptr, JIT_CODE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(code != MAP_FAILED)
+            jit->code = (byte*)code;
+        if(code == MAP_FAILED || !protect(jit->code, false)){
+            flush_jit();
+            return run_blocks(until); // no executable memory, stay on the interpreter
+        }
+    }
+
+    // like the block cache, the page holding the run_until() address is interpreted
+    unsigned long long now = cycles;
+    STOPS6502 stop = STOP_CYCLES;
+    while(now < deadline){
+        if(pc >= STACK_BASE + 0x100 && (pc >> 8) != (until >> 8) && read_pages[pc >> 8]){
+            JitPage *&page = jit->pages[pc >> 8];
+            if(!page){
+                page = new JitPage;
+                code_pages[pc >> 8] = true;
+            }
+            if(JitBlock block = page->code[pc & 0xff]){
+                sb = status(); // native code works on the packed status register
+                cycles = now;
+                block(this);
+                set_status(sb);
+                if(cycles != now){
+                    now = cycles;
+                    continue;
+                }
+                // left in front of its first instruction, the interpreter runs that one
+            }
+            else{
+                byte &hits = page->hits[pc & 0xff];
+                if(hits != JIT_UNCOMPILABLE && ++hits >= JIT_THRESHOLD){
+                    if(compile(pc))
+                        continue;
+                    hits = JIT_UNCOMPILABLE;
+                }
+            }
+        }
+        if(pc == until){
+            stop = STOP_PC;
+            break;
+        }
+        cycles = now; // for devices, see scheduler.cpp
+        byte opcode = read(pc++);
+        byte taken = execute_opcode(*this, opcode);
+        if(!taken){
+            stop = stop_reason(opcode);
+            break;
+        }
+        now += taken;
+    }
+    cycles = now;
+    return stop;
+}
+
+#else
+
+bool Dodgy6502::compile(word){
+    return false;
+}
+
+void Dodgy6502::invalidate_jit(byte){}
+
+void Dodgy6502::flush_jit(){}
+
+Dodgy6502::STOPS6502 Dodgy6502::run_jit(unsigned int until){
+    return run_blocks(until);
+}
+
+#endif
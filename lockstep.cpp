@@ -0,0 +1,154 @@
+# include "lockstep.h"
+# include "dispatch.h"
+# include <stdexcept>
+
+// Every round picks a lane and executes the instruction at its pc on all lanes at the same
+// pc that read the same opcode there. The opcode is dispatched once for the whole group
+// and the same handler from dispatch.h runs over its lanes, so the semantics are the ones
+// of the single CPU engines. Lanes that branched elsewhere wait for a later round: the
+// lane at the lowest pc goes first, which lets the lanes that fell behind catch up, so
+// lanes that diverged on a branch join again where the two paths meet. A lane more than
+// MAX_SKEW cycles behind goes first instead, so a lane spinning at a low address cannot
+// starve the others.
+//
+// The registers stay in the lanes, the handlers work on a Dodgy6502. What the lanes
+// share is the fetch, the dispatch and a warm handler, which is most of what an
+// interpreter spends on a simple instruction. Register arrays with the register
+// instructions stepped over all lanes at once came out slower: blending a result into
+// the arrays costs about what the handler does, and the fetch per lane stays.
+
+namespace {
+
+unsigned int lowest_lane(unsigned int mask){
+#if defined(__GNUC__)
+    return __builtin_ctz(mask);
+#else
+    unsigned int lane = 0;
+    while(!(mask & 1)){
+        mask >>= 1;
+        lane++;
+    }
+    return lane;
+#endif
+}
+
+// bit of each lane in a lane mask, a table so the loops building masks vectorize
+const unsigned int lane_bit[32] = {
+    1u << 0, 1u << 1, 1u << 2, 1u << 3, 1u << 4, 1u << 5, 1u << 6, 1u << 7,
+    1u << 8, 1u << 9, 1u << 10, 1u << 11, 1u << 12, 1u << 13, 1u << 14, 1u << 15,
+    1u << 16, 1u << 17, 1u << 18, 1u << 19, 1u << 20, 1u << 21, 1u << 22, 1u << 23,
+    1u << 24, 1u << 25, 1u << 26, 1u << 27, 1u << 28, 1u << 29, 1u << 30, 1u << 31};
+
+}
+
+Lockstep::Lockstep(unsigned int lanes) : count(lanes){
+    if(!lanes || lanes > MAX_LANES)
+        throw std::runtime_error("Lockstep: between 1 and 32 lanes");
+    cpus.reset(new Dodgy6502[lanes]);
+    for(unsigned int i = 0; i < MAX_LANES; i++){
+        stops[i] = Dodgy6502::STOP_NONE;
+        pcs[i] = 0;
+        deadlines[i] = 0;
+    }
+}
+
+word Lockstep::lowest_pc() const{
+    word lowest = 0xffff; // or every running lane is at $FFFF
+    unsigned int live = running;
+    for(unsigned int i = 0; i < MAX_LANES; i++){
+        word pc = pcs[i] | (live & lane_bit[i] ? 0 : 0xffff);
+        lowest = pc < lowest ? pc : lowest;
+    }
+    return lowest;
+}
+
+unsigned int Lockstep::lanes_at(word pc) const{
+    unsigned int lanes = 0;
+    for(unsigned int i = 0; i < MAX_LANES; i++)
+        lanes |= pcs[i] == pc ? lane_bit[i] : 0;
+    return lanes & running;
+}
+
+// The group of the lane at the lowest pc, or of the lane furthest behind if that is more
+// than MAX_SKEW cycles behind it. Opcodes are peeked through the page tables: at a pc on a
+// device page the lane furthest behind fetches its opcode for real and runs alone.
+unsigned int Lockstep::next_group(word &pc, byte &opcode) const{
+    pc = lowest_pc();
+    unsigned int group = lanes_at(pc);
+    unsigned int lead = lowest_lane(group);
+    if(group != running){ // not all in step, one of the others may be far behind
+        unsigned long long lead_cycles = cpus[lead].cycles;
+        for(unsigned int rest = running & ~group; rest; rest &= rest - 1){
+            unsigned int i = lowest_lane(rest);
+            if(cpus[i].cycles + MAX_SKEW < lead_cycles && cpus[i].cycles < cpus[lead].cycles)
+                lead = i;
+        }
+        if(pcs[lead] != pc){
+            pc = pcs[lead];
+            group = lanes_at(pc);
+        }
+    }
+    const byte* page = cpus[lead].read_pages[pc >> 8];
+    if(!page){
+        for(unsigned int rest = group; rest; rest &= rest - 1){
+            unsigned int i = lowest_lane(rest);
+            if(cpus[i].cycles < cpus[lead].cycles)
+                lead = i;
+        }
+        opcode = cpus[lead].read(pc);
+        return 1u << lead;
+    }
+    opcode = page[pc & 0xff];
+    // lanes whose memory holds another opcode at pc form their own group in a later round
+    for(unsigned int rest = group; rest; rest &= rest - 1){
+        unsigned int i = lowest_lane(rest);
+        const byte* lane_page = cpus[i].read_pages[pc >> 8];
+        if(!lane_page || lane_page[pc & 0xff] != opcode)
+            group &= ~(1u << i);
+    }
+    return group;
+}
+
+template<byte(Dodgy6502::*addr_mode)(), byte(Dodgy6502::*implementation)(), byte cycles>
+void Lockstep::execute_group(unsigned int group, byte opcode){
+    for(; group; group &= group - 1){
+        unsigned int i = lowest_lane(group);
+        Dodgy6502 &cpu = cpus[i];
+        cpu.pc++;
+        byte taken = execute<addr_mode, implementation, cycles>(cpu);
+        if(!taken){
+            stops[i] = stop_reason(opcode);
+            running &= ~(1u << i);
+            continue;
+        }
+        cpu.cycles += taken;
+        pcs[i] = cpu.pc;
+        instructions++;
+        if(cpu.cycles >= deadlines[i])
+            running &= ~(1u << i);
+    }
+}
+
+DODGY_FLATTEN void Lockstep::run_for(unsigned long long budget){
+    running = 0;
+    for(unsigned int i = 0; i < count; i++){
+        Dodgy6502 &cpu = cpus[i];
+        deadlines[i] = budget > ~0ull - cpu.cycles ? ~0ull : cpu.cycles + budget;
+        pcs[i] = cpu.pc;
+        stops[i] = Dodgy6502::STOP_CYCLES;
+        if(cpu.cycles < deadlines[i])
+            running |= 1u << i;
+    }
+    while(running){
+        word pc;
+        byte opcode;
+        unsigned int group = next_group(pc, opcode);
+        dispatches++;
+        switch(opcode){
+#define LOCKSTEP_CASE(opc, name, mode, impl, cycles, description) \
+            case opc: execute_group<&Dodgy6502::mode, &Dodgy6502::impl, cycles>(group, opc); break;
+            DODGY6502_OPCODES(LOCKSTEP_CASE)
+#undef LOCKSTEP_CASE
+        }
+    }
+}
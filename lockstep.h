@@ -0,0 +1,43 @@
+#pragma once
+#include "6502v2.h"
+#include <memory>
+
+// Runs up to 32 CPUs on one thread in lockstep, meant for one program run over many
+// inputs, see lockstep.cpp. Every lane is a complete Dodgy6502 with its own registers and
+// memory: load each one like a single CPU, then run them together. Device events and
+// interrupts are not delivered to the lanes.
+class Lockstep {
+public:
+    static const unsigned int MAX_LANES = 32;
+    static const unsigned int MAX_SKEW = 64; // cycles a lane falls behind before it runs out of turn
+    explicit Lockstep(unsigned int lanes = 16);
+
+    Dodgy6502& lane(unsigned int index) { return cpus[index]; }
+    unsigned int lane_count() const { return count; }
+    Dodgy6502::STOPS6502 stop(unsigned int index) const { return stops[index]; } // why a lane stopped in the last run
+
+    // each lane runs until it used `budget` more cycles or halts
+    void run_for(unsigned long long budget);
+    void run() { run_for(~0ull); }
+
+    // instructions executed and opcodes dispatched for them, the lanes ran in step
+    // instructions / dispatches of them on average
+    unsigned long long instructions = 0;
+    unsigned long long dispatches = 0;
+
+private:
+    unsigned int count;
+    std::unique_ptr<Dodgy6502[]> cpus;
+    Dodgy6502::STOPS6502 stops[MAX_LANES];
+
+    // kept beside the lanes as arrays so finding a group is a loop the compiler vectorizes
+    alignas(64) word pcs[MAX_LANES];
+    alignas(64) unsigned long long deadlines[MAX_LANES];
+    unsigned int running = 0; // bit per lane that has not stopped yet
+
+    word lowest_pc() const;
+    unsigned int lanes_at(word pc) const;
+    unsigned int next_group(word &pc, byte &opcode) const;
+    template<byte(Dodgy6502::*addr_mode)(), byte(Dodgy6502::*implementation)(), byte cycles>
+    void execute_group(unsigned int group, byte opcode);
+};
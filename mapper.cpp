@@ -0,0 +1,67 @@
+# include "6502v2.h"
+# include <stdexcept>
+
+// A mapper is a bus device that is only mapped for writes: trapped pages keep the read
+// pointer of their bank, so code and data are read at full speed, but their write pointer
+// is null and the store reaches Mapper::write() through write_slow(). Selecting a bank goes
+// through the map functions of the bus, which drop the cached code of the swapped pages.
+// The selected bank is read back from the page table instead of being kept beside it, so
+// a restored snapshot selects the bank it was taken with.
+
+byte Mapper::read(word){
+    return 0;
+}
+
+void Mapper::trap_writes(byte first_page, int pages){
+    if(first_page < 2 || first_page + pages > 256)
+        throw std::runtime_error("Mapper registers outside the banked pages");
+    for(int page = first_page; page < first_page + pages; page++){
+        trapped[page] = true;
+        cpu.write_pages[page] = nullptr;
+        cpu.devices[page] = this;
+    }
+}
+
+void Mapper::select_rom(byte first_page, int pages, const byte* bank){
+    cpu.map_rom(first_page, pages, bank);
+    for(int page = first_page; page < first_page + pages; page++){
+        if(trapped[page]){
+            cpu.write_pages[page] = nullptr;
+            cpu.devices[page] = this;
+        }
+    }
+}
+
+void Mapper::select_ram(byte first_page, int pages, byte* bank){
+    cpu.map_bank(first_page, pages, bank);
+    for(int page = first_page; page < first_page + pages; page++){
+        if(trapped[page]){
+            cpu.write_pages[page] = nullptr;
+            cpu.devices[page] = this;
+        }
+    }
+}
+
+RomBanks::RomBanks(Dodgy6502 &cpu, byte first_page, int pages, const byte* banks, int count)
+        : Mapper(cpu), first_page(first_page), pages(pages), banks(banks), count(count){
+    if(count <= 0)
+        throw std::runtime_error("No ROM banks");
+    select_rom(first_page, pages, banks);
+    trap_writes(first_page, pages);
+}
+
+RomBanks::RomBanks(Dodgy6502 &cpu, byte first_page, int pages, const RomFile &rom, size_t offset, int count)
+        : RomBanks(cpu, first_page, pages, rom.at(offset, count > 0 ? pages * count : 0), count){
+}
+
+int RomBanks::selected() const{
+    return (cpu.read_pages[first_page] - banks) / (pages << 8);
+}
+
+// the bank number wraps around like the unused high bits of a real bank register
+void RomBanks::write(word, byte data){
+    int bank = data % count;
+    if(bank == selected())
+        return;
+    select_rom(first_page, pages, banks + (bank * pages << 8));
+}
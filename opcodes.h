@@ -0,0 +1,268 @@
+#pragma once
+
+// Every 6502 opcode, shared by every execution engine.
+// X(opcode, name, addressing mode, implementation, base cycles, description)
+#define DODGY6502_OPCODES(X) DODGY6502_OFFICIAL_OPCODES(X) DODGY6502_ILLEGAL_OPCODES(X)
+
+// Accumulator forms of the shifts/rotates use imp with their own *_A implementation.
+#define DODGY6502_OFFICIAL_OPCODES(X) \
+    X(0x00, "BRK", imp, BRK,   7, "BRK: Force Break")                                \
+    X(0x01, "ORA", izx, ORA,   6, "ORA-izx: 'OR' Memory with Accum")                 \
+    X(0x05, "ORA", zp,  ORA,   3, "ORA-zp: 'OR' Memory with Accum")                  \
+    X(0x06, "ASL", zp,  ASL,   5, "ASL-zp: Shift Left One Bit (Mem)")                \
+    X(0x08, "PHP", imp, PHP,   3, "PHP: Push Processor Status on Stack")             \
+    X(0x09, "ORA", imm, ORA,   2, "ORA-imm: 'OR' Memory with Accum")                 \
+    X(0x0A, "ASL", imp, ASL_A, 2, "ASL-A: Shift Left One Bit (Accum)")               \
+    X(0x0D, "ORA", abs, ORA,   4, "ORA-abs: 'OR' Memory with Accum")                 \
+    X(0x0E, "ASL", abs, ASL,   6, "ASL-abs: Shift Left One Bit (Mem)")               \
+    X(0x10, "BPL", rel, BPL,   2, "BPL: Branch on Plus")                             \
+    X(0x11, "ORA", izy, ORA,   5, "ORA-izy: 'OR' Memory with Accum")                 \
+    X(0x15, "ORA", zpx, ORA,   4, "ORA-zpx: 'OR' Memory with Accum")                 \
+    X(0x16, "ASL", zpx, ASL,   6, "ASL-zpx: Shift Left One Bit (Mem)")               \
+    X(0x18, "CLC", imp, CLC,   2, "CLC: Clear Carry Flag")                           \
+    X(0x19, "ORA", aby, ORA,   4, "ORA-aby: 'OR' Memory with Accum")                 \
+    X(0x1D, "ORA", abx, ORA,   4, "ORA-abx: 'OR' Memory with Accum")                 \
+    X(0x1E, "ASL", abx, ASL,   7, "ASL-abx: Shift Left One Bit (Mem)")               \
+    X(0x20, "JSR", abs, JSR,   6, "JSR-abs: Jump to Subroutine")                     \
+    X(0x21, "AND", izx, AND,   6, "AND-izx: 'AND' Memory with Accum")                \
+    X(0x24, "BIT", zp,  BIT,   3, "BIT-zp: Test Bits in Accum with Memory")          \
+    X(0x25, "AND", zp,  AND,   3, "AND-zp: 'AND' Memory with Accum")                 \
+    X(0x26, "ROL", zp,  ROL,   5, "ROL-zp: Rotate One Bit Left (Mem)")               \
+    X(0x28, "PLP", imp, PLP,   4, "PLP: Pull Processor Status from Stack")           \
+    X(0x29, "AND", imm, AND,   2, "AND-imm: 'AND' Memory with Accum")                \
+    X(0x2A, "ROL", imp, ROL_A, 2, "ROL-A: Rotate One Bit Left (Accum)")              \
+    X(0x2C, "BIT", abs, BIT,   4, "BIT-abs: Test Bits in Accum with Memory")         \
+    X(0x2D, "AND", abs, AND,   4, "AND-abs: 'AND' Memory with Accum")                \
+    X(0x2E, "ROL", abs, ROL,   6, "ROL-abs: Rotate One Bit Left (Mem)")              \
+    X(0x30, "BMI", rel, BMI,   2, "BMI: Branch on Minus")                            \
+    X(0x31, "AND", izy, AND,   5, "AND-izy: 'AND' Memory with Accum")                \
+    X(0x35, "AND", zpx, AND,   4, "AND-zpx: 'AND' Memory with Accum")                \
+    X(0x36, "ROL", zpx, ROL,   6, "ROL-zpx: Rotate One Bit Left (Mem)")              \
+    X(0x38, "SEC", imp, SEC,   2, "SEC: Set Carry Flag")                             \
+    X(0x39, "AND", aby, AND,   4, "AND-aby: 'AND' Memory with Accum")                \
+    X(0x3D, "AND", abx, AND,   4, "AND-abx: 'AND' Memory with Accum")                \
+    X(0x3E, "ROL", abx, ROL,   7, "ROL-abx: Rotate One Bit Left (Mem)")              \
+    X(0x40, "RTI", imp, RTI,   6, "RTI: Return from Interrupt")                      \
+    X(0x41, "EOR", izx, EOR,   6, "EOR-izx: 'Exclusive Or' Memory with Accum")       \
+    X(0x45, "EOR", zp,  EOR,   3, "EOR-zp: 'Exclusive Or' Memory with Accum")        \
+    X(0x46, "LSR", zp,  LSR,   5, "LSR-zp: Shift One Bit Right (Mem)")               \
+    X(0x48, "PHA", imp, PHA,   3, "PHA: Push Accum on Stack")                        \
+    X(0x49, "EOR", imm, EOR,   2, "EOR-imm: 'Exclusive Or' Memory with Accum")       \
+    X(0x4A, "LSR", imp, LSR_A, 2, "LSR-A: Shift One Bit Right (Accum)")              \
+    X(0x4C, "JMP", abs, JMP,   3, "JMP-abs: Jump")                                   \
+    X(0x4D, "EOR", abs, EOR,   4, "EOR-abs: 'Exclusive Or' Memory with Accum")       \
+    X(0x4E, "LSR", abs, LSR,   6, "LSR-abs: Shift One Bit Right (Mem)")              \
+    X(0x50, "BVC", rel, BVC,   2, "BVC: Branch on Overflow Clear")                   \
+    X(0x51, "EOR", izy, EOR,   5, "EOR-izy: 'Exclusive Or' Memory with Accum")       \
+    X(0x55, "EOR", zpx, EOR,   4, "EOR-zpx: 'Exclusive Or' Memory with Accum")       \
+    X(0x56, "LSR", zpx, LSR,   6, "LSR-zpx: Shift One Bit Right (Mem)")              \
+    X(0x58, "CLI", imp, CLI,   2, "CLI: Clear Interrupt Disable Bit")                \
+    X(0x59, "EOR", aby, EOR,   4, "EOR-aby: 'Exclusive Or' Memory with Accum")       \
+    X(0x5D, "EOR", abx, EOR,   4, "EOR-abx: 'Exclusive Or' Memory with Accum")       \
+    X(0x5E, "LSR", abx, LSR,   7, "LSR-abx: Shift One Bit Right (Mem)")              \
+    X(0x60, "RTS", imp, RTS,   6, "RTS: Return from Subroutine")                     \
+    X(0x61, "ADC", izx, ADC,   6, "ADC-izx: Add Memory to Accum with Carry")         \
+    X(0x65, "ADC", zp,  ADC,   3, "ADC-zp: Add Memory to Accum with Carry")          \
+    X(0x66, "ROR", zp,  ROR,   5, "ROR-zp: Rotate One Bit Right (Mem)")              \
+    X(0x68, "PLA", imp, PLA,   4, "PLA: Pull Accum from Stack")                      \
+    X(0x69, "ADC", imm, ADC,   2, "ADC-imm: Add Memory to Accum with Carry")         \
+    X(0x6A, "ROR", imp, ROR_A, 2, "ROR-A: Rotate One Bit Right (Accum)")             \
+    X(0x6C, "JMP", ind, JMP,   5, "JMP-ind: Jump")                                   \
+    X(0x6D, "ADC", abs, ADC,   4, "ADC-abs: Add Memory to Accum with Carry")         \
+    X(0x6E, "ROR", abs, ROR,   6, "ROR-abs: Rotate One Bit Right (Mem)")             \
+    X(0x70, "BVS", rel, BVS,   2, "BVS: Branch on Overflow Set")                     \
+    X(0x71, "ADC", izy, ADC,   5, "ADC-izy: Add Memory to Accum with Carry")         \
+    X(0x75, "ADC", zpx, ADC,   4, "ADC-zpx: Add Memory to Accum with Carry")         \
+    X(0x76, "ROR", zpx, ROR,   6, "ROR-zpx: Rotate One Bit Right (Mem)")             \
+    X(0x78, "SEI", imp, SEI,   2, "SEI: Set Interrupt Disable Status")               \
+    X(0x79, "ADC", aby, ADC,   4, "ADC-aby: Add Memory to Accum with Carry")         \
+    X(0x7D, "ADC", abx, ADC,   4, "ADC-abx: Add Memory to Accum with Carry")         \
+    X(0x7E, "ROR", abx, ROR,   7, "ROR-abx: Rotate One Bit Right (Mem)")             \
+    X(0x81, "STA", izx, STA,   6, "STA-izx: Store Accum in Memory")                  \
+    X(0x84, "STY", zp,  STY,   3, "STY-zp: Store Y in Memory")                       \
+    X(0x85, "STA", zp,  STA,   3, "STA-zp: Store Accum in Memory")                   \
+    X(0x86, "STX", zp,  STX,   3, "STX-zp: Store X in Memory")                       \
+    X(0x88, "DEY", imp, DEY,   2, "DEY: Decrement Y by One")                         \
+    X(0x8A, "TXA", imp, TXA,   2, "TXA: Transfer X to Accum")                        \
+    X(0x8C, "STY", abs, STY,   4, "STY-abs: Store Y in Memory")                      \
+    X(0x8D, "STA", abs, STA,   4, "STA-abs: Store Accum in Memory")                  \
+    X(0x8E, "STX", abs, STX,   4, "STX-abs: Store X in Memory")                      \
+    X(0x90, "BCC", rel, BCC,   2, "BCC: Branch on Carry Clear")                      \
+    X(0x91, "STA", izy, STA,   6, "STA-izy: Store Accum in Memory")                  \
+    X(0x94, "STY", zpx, STY,   4, "STY-zpx: Store Y in Memory")                      \
+    X(0x95, "STA", zpx, STA,   4, "STA-zpx: Store Accum in Memory")                  \
+    X(0x96, "STX", zpy, STX,   4, "STX-zpy: Store X in Memory")                      \
+    X(0x98, "TYA", imp, TYA,   2, "TYA: Transfer Y to Accum")                        \
+    X(0x99, "STA", aby, STA,   5, "STA-aby: Store Accum in Memory")                  \
+    X(0x9A, "TXS", imp, TXS,   2, "TXS: Transfer X to Stack Pointer")                \
+    X(0x9D, "STA", abx, STA,   5, "STA-abx: Store Accum in Memory")                  \
+    X(0xA0, "LDY", imm, LDY,   2, "LDY-imm: Load Y with Memory")                     \
+    X(0xA1, "LDA", izx, LDA,   6, "LDA-izx: Load Accum with Memory")                 \
+    X(0xA2, "LDX", imm, LDX,   2, "LDX-imm: Load X with Memory")                     \
+    X(0xA4, "LDY", zp,  LDY,   3, "LDY-zp: Load Y with Memory")                      \
+    X(0xA5, "LDA", zp,  LDA,   3, "LDA-zp: Load Accum with Memory")                  \
+    X(0xA6, "LDX", zp,  LDX,   3, "LDX-zp: Load X with Memory")                      \
+    X(0xA8, "TAY", imp, TAY,   2, "TAY: Transfer Accum to Y")                        \
+    X(0xA9, "LDA", imm, LDA,   2, "LDA-imm: Load Accum with Memory")                 \
+    X(0xAA, "TAX", imp, TAX,   2, "TAX: Transfer Accum to X")                        \
+    X(0xAC, "LDY", abs, LDY,   4, "LDY-abs: Load Y with Memory")                     \
+    X(0xAD, "LDA", abs, LDA,   4, "LDA-abs: Load Accum with Memory")                 \
+    X(0xAE, "LDX", abs, LDX,   4, "LDX-abs: Load X with Memory")                     \
+    X(0xB0, "BCS", rel, BCS,   2, "BCS: Branch on Carry Set")                        \
+    X(0xB1, "LDA", izy, LDA,   5, "LDA-izy: Load Accum with Memory")                 \
+    X(0xB4, "LDY", zpx, LDY,   4, "LDY-zpx: Load Y with Memory")                     \
+    X(0xB5, "LDA", zpx, LDA,   4, "LDA-zpx: Load Accum with Memory")                 \
+    X(0xB6, "LDX", zpy, LDX,   4, "LDX-zpy: Load X with Memory")                     \
+    X(0xB8, "CLV", imp, CLV,   2, "CLV: Clear Overflow Flag")                        \
+    X(0xB9, "LDA", aby, LDA,   4, "LDA-aby: Load Accum with Memory")                 \
+    X(0xBA, "TSX", imp, TSX,   2, "TSX: Transfer Stack Pointer to X")                \
+    X(0xBC, "LDY", abx, LDY,   4, "LDY-abx: Load Y with Memory")                     \
+    X(0xBD, "LDA", abx, LDA,   4, "LDA-abx: Load Accum with Memory")                 \
+    X(0xBE, "LDX", aby, LDX,   4, "LDX-aby: Load X with Memory")                     \
+    X(0xC0, "CPY", imm, CPY,   2, "CPY-imm: Compare Memory with Y")                  \
+    X(0xC1, "CMP", izx, CMP,   6, "CMP-izx: Compare Memory with Accum")              \
+    X(0xC4, "CPY", zp,  CPY,   3, "CPY-zp: Compare Memory with Y")                   \
+    X(0xC5, "CMP", zp,  CMP,   3, "CMP-zp: Compare Memory with Accum")               \
+    X(0xC6, "DEC", zp,  DEC,   5, "DEC-zp: Decrement Memory by One")                 \
+    X(0xC8, "INY", imp, INY,   2, "INY: Increment Y by One")                         \
+    X(0xC9, "CMP", imm, CMP,   2, "CMP-imm: Compare Memory with Accum")              \
+    X(0xCA, "DEX", imp, DEX,   2, "DEX: Decrement X by One")                         \
+    X(0xCC, "CPY", abs, CPY,   4, "CPY-abs: Compare Memory with Y")                  \
+    X(0xCD, "CMP", abs, CMP,   4, "CMP-abs: Compare Memory with Accum")              \
+    X(0xCE, "DEC", abs, DEC,   6, "DEC-abs: Decrement Memory by One")                \
+    X(0xD0, "BNE", rel, BNE,   2, "BNE: Branch on Result not Zero")                  \
+    X(0xD1, "CMP", izy, CMP,   5, "CMP-izy: Compare Memory with Accum")              \
+    X(0xD5, "CMP", zpx, CMP,   4, "CMP-zpx: Compare Memory with Accum")              \
+    X(0xD6, "DEC", zpx, DEC,   6, "DEC-zpx: Decrement Memory by One")                \
+    X(0xD8, "CLD", imp, CLD,   2, "CLD: Clear Decimal Mode")                         \
+    X(0xD9, "CMP", aby, CMP,   4, "CMP-aby: Compare Memory with Accum")              \
+    X(0xDD, "CMP", abx, CMP,   4, "CMP-abx: Compare Memory with Accum")              \
+    X(0xDE, "DEC", abx, DEC,   7, "DEC-abx: Decrement Memory by One")                \
+    X(0xE0, "CPX", imm, CPX,   2, "CPX-imm: Compare Memory with X")                  \
+    X(0xE1, "SBC", izx, SBC,   6, "SBC-izx: Subtract Memory from Accum with Borrow") \
+    X(0xE4, "CPX", zp,  CPX,   3, "CPX-zp: Compare Memory with X")                   \
+    X(0xE5, "SBC", zp,  SBC,   3, "SBC-zp: Subtract Memory from Accum with Borrow")  \
+    X(0xE6, "INC", zp,  INC,   5, "INC-zp: Increment Memory by One")                 \
+    X(0xE8, "INX", imp, INX,   2, "INX: Increment X by One")                         \
+    X(0xE9, "SBC", imm, SBC,   2, "SBC-imm: Subtract Memory from Accum with Borrow") \
+    X(0xEA, "NOP", imp, NOP,   2, "NOP: No Operation")                               \
+    X(0xEC, "CPX", abs, CPX,   4, "CPX-abs: Compare Memory with X")                  \
+    X(0xED, "SBC", abs, SBC,   4, "SBC-abs: Subtract Memory from Accum with Borrow") \
+    X(0xEE, "INC", abs, INC,   6, "INC-abs: Increment Memory by One")                \
+    X(0xF0, "BEQ", rel, BEQ,   2, "BEQ: Branch on Result Zero")                      \
+    X(0xF1, "SBC", izy, SBC,   5, "SBC-izy: Subtract Memory from Accum with Borrow") \
+    X(0xF5, "SBC", zpx, SBC,   4, "SBC-zpx: Subtract Memory from Accum with Borrow") \
+    X(0xF6, "INC", zpx, INC,   6, "INC-zpx: Increment Memory by One")                \
+    X(0xF8, "SED", imp, SED,   2, "SED: Set Decimal Mode")                           \
+    X(0xF9, "SBC", aby, SBC,   4, "SBC-aby: Subtract Memory from Accum with Borrow") \
+    X(0xFD, "SBC", abx, SBC,   4, "SBC-abx: Subtract Memory from Accum with Borrow") \
+    X(0xFE, "INC", abx, INC,   7, "INC-abx: Increment Memory by One")
+
+// The undocumented opcodes halt the CPU: JAM stops it like the real chip does, the
+// others are reported as invalid instead of emulating their side effects.
+#define DODGY6502_ILLEGAL_OPCODES(X) \
+    X(0x02, "JAM", imp, JAM,   0, "JAM: Halt the CPU")                               \
+    X(0x03, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x04, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x07, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x0B, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x0C, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x0F, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x12, "JAM", imp, JAM,   0, "JAM: Halt the CPU")                               \
+    X(0x13, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x14, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x17, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x1A, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x1B, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x1C, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x1F, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x22, "JAM", imp, JAM,   0, "JAM: Halt the CPU")                               \
+    X(0x23, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x27, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x2B, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x2F, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x32, "JAM", imp, JAM,   0, "JAM: Halt the CPU")                               \
+    X(0x33, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x34, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x37, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x3A, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x3B, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x3C, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x3F, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x42, "JAM", imp, JAM,   0, "JAM: Halt the CPU")                               \
+    X(0x43, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x44, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x47, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x4B, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x4F, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x52, "JAM", imp, JAM,   0, "JAM: Halt the CPU")                               \
+    X(0x53, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x54, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x57, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x5A, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x5B, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x5C, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x5F, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x62, "JAM", imp, JAM,   0, "JAM: Halt the CPU")                               \
+    X(0x63, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x64, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x67, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x6B, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x6F, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x72, "JAM", imp, JAM,   0, "JAM: Halt the CPU")                               \
+    X(0x73, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x74, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x77, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x7A, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x7B, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x7C, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x7F, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x80, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x82, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x83, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x87, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x89, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x8B, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x8F, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x92, "JAM", imp, JAM,   0, "JAM: Halt the CPU")                               \
+    X(0x93, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x97, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x9B, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x9C, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x9E, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0x9F, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xA3, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xA7, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xAB, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xAF, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xB2, "JAM", imp, JAM,   0, "JAM: Halt the CPU")                               \
+    X(0xB3, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xB7, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xBB, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xBF, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xC2, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xC3, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xC7, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xCB, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xCF, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xD2, "JAM", imp, JAM,   0, "JAM: Halt the CPU")                               \
+    X(0xD3, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xD4, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xD7, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xDA, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xDB, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xDC, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xDF, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xE2, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xE3, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xE7, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xEB, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xEF, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xF2, "JAM", imp, JAM,   0, "JAM: Halt the CPU")                               \
+    X(0xF3, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xF4, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xF7, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xFA, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xFB, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xFC, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")                             \
+    X(0xFF, "ILL", imp, ILL,   0, "ILL: Illegal Opcode")
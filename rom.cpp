@@ -0,0 +1,87 @@
+# include "6502v2.h"
+# include <stdexcept>
+# include <string>
+# include <map>
+# include <memory>
+# include <mutex>
+# include <algorithm>
+# include <fcntl.h>
+# include <unistd.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+
+// ROM files are mapped read only and never copied. load_rom() maps every whole page of the
+// image copy on write, so CPUs running the same firmware share the mapping until they write
+// to it. A file that ends inside a page still maps that page, the rest of the system page
+// behind the end of the file reads as zeros. Files can be larger than 64KB, the banks of
+// a RomBanks window for one, at() checks every range mapped from them.
+
+RomFile::RomFile(const char* filename){
+    int fd = open(filename, O_RDONLY);
+    if(fd < 0)
+        throw std::runtime_error("Failed to load ROM");
+    struct stat info;
+    if(fstat(fd, &info) != 0){
+        close(fd);
+        throw std::runtime_error("Failed reading ROM");
+    }
+    size = info.st_size;
+    long system_page = sysconf(_SC_PAGESIZE);
+    readable = (size + system_page - 1) / system_page * system_page;
+    if(size){
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(mapping == MAP_FAILED){
+            close(fd);
+            throw std::runtime_error("Failed reading ROM");
+        }
+        data = (const byte*)mapping;
+    }
+    close(fd); // the mapping stays valid
+}
+
+RomFile::~RomFile(){
+    if(data)
+        munmap((void*)data, size);
+}
+
+const byte* RomFile::at(size_t offset, int pages) const{
+    if(pages < 0 || offset > readable || (size_t)pages << 8 > readable - offset)
+        throw std::runtime_error("Pages past the end of the ROM");
+    return data + offset;
+}
+
+const RomFile& RomFile::shared(const char* filename){
+    static std::mutex lock;
+    static std::map<std::string, std::unique_ptr<RomFile>> files;
+    std::lock_guard<std::mutex> guard(lock);
+    std::unique_ptr<RomFile> &file = files[filename];
+    if(!file)
+        file.reset(new RomFile(filename));
+    return *file;
+}
+
+void Dodgy6502::load_rom(const char *filename, word base){
+    load_rom(RomFile::shared(filename), base);
+}
+
+// Zero page and stack always are RAM and a base inside a page cannot be mapped, those
+// parts are copied into RAM instead, as is a last page that would reach past the system
+// page the file ends in.
+void Dodgy6502::load_rom(const RomFile &rom, word base){
+    if(rom.size > 0x10000u - base)
+        throw std::runtime_error("ROM too large");
+    unsigned int address = base, end = base + rom.size;
+    if(address & 0xff || address < STACK_BASE + 0x100){
+        unsigned int copied = std::min(end, address < STACK_BASE + 0x100u ? STACK_BASE + 0x100u : (address | 0xff) + 1);
+        load_memory(rom.data, copied - address, address);
+        address = copied;
+    }
+    int pages = address < end ? (end - address + 0xff) >> 8 : 0;
+    if(pages && (size_t)(address - base) + (pages << 8) > rom.readable){
+        pages--;
+        unsigned int last = address + (pages << 8);
+        load_memory(rom.data + (last - base), end - last, last);
+    }
+    if(pages)
+        map_image(address >> 8, pages, rom.at(address - base, pages));
+}
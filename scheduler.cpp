@@ -0,0 +1,41 @@
+# include "6502v2.h"
+# include <algorithm>
+
+// Devices schedule events at a cycle instead of being polled after every instruction.
+// run_engine() hands the engine the earliest pending event as its deadline, dispatches the
+// events that are due once the engine returns and carries on. A device access can schedule
+// an event while an engine runs, schedule() then lowers the deadline the engine is checking.
+// The engines store the cycle count of the instruction they are about to execute into
+// `cycles`, so a device reading it during an access sees the current time.
+
+static bool later(const Dodgy6502::Event &a, const Dodgy6502::Event &b){
+    return a.at > b.at;
+}
+
+void Dodgy6502::schedule(unsigned long long at, TimedDevice* device, int id){
+    cancel(device, id);
+    events.push_back({at, device, id});
+    std::push_heap(events.begin(), events.end(), later);
+    if(at < deadline)
+        deadline = at;
+}
+
+void Dodgy6502::cancel(TimedDevice* device, int id){
+    for(auto event = events.begin(); event != events.end(); ++event){
+        if(event->device == device && event->id == id){
+            events.erase(event);
+            std::make_heap(events.begin(), events.end(), later);
+            return;
+        }
+    }
+}
+
+// an event scheduled again from its own callback has to be in the future, or it runs again
+void Dodgy6502::dispatch_events(){
+    while(!events.empty() && events.front().at <= cycles){
+        Event event = events.front();
+        std::pop_heap(events.begin(), events.end(), later);
+        events.pop_back();
+        event.device->event(*this, event.id);
+    }
+}
@@ -0,0 +1,87 @@
+# include "6502v2.h"
+# include <stdexcept>
+# include <cstring>
+
+// A snapshot copies every RAM page once and then write protects them: the write pointer of
+// each RAM page is cleared like that of a page not written yet, so the first store to it
+// after the snapshot goes through write_slow(), which marks it dirty and hands back the
+// pointer. Every later store to the page is a plain store again. remapped() marks pages
+// too, so restore() only copies back and remaps the pages in dirty_pages, and leaves the
+// code caches of all other pages warm. Zero page and stack are stored to directly and
+// are always copied, they are two pages. Banks mapped with map_bank() are not RAM of the
+// CPU and are neither protected nor saved.
+
+void Dodgy6502::snapshot(Snapshot &saved){
+    saved.cpu = this;
+    saved.number = ++snapshots;
+    saved.a = a;
+    saved.x = x;
+    saved.y = y;
+    saved.sp = sp;
+    saved.p = status();
+    saved.pc = pc;
+    saved.cycles = cycles;
+    saved.interrupts = interrupts;
+    saved.events = events;
+
+    saved.ram.clear();
+    for(int page = 0; page < 256; page++){
+        saved.ram_offsets[page] = -1;
+        if(ram_pages[page]){
+            saved.ram_offsets[page] = saved.ram.size();
+            saved.ram.insert(saved.ram.end(), ram_pages[page], ram_pages[page] + 256);
+        }
+        if(page >= 2 && write_pages[page] && write_pages[page] == ram_pages[page])
+            write_pages[page] = nullptr;
+    }
+    memcpy(saved.read_pages, read_pages, sizeof read_pages);
+    memcpy(saved.write_pages, write_pages, sizeof write_pages);
+    memcpy(saved.devices, devices, sizeof devices);
+
+    for(auto &bits : dirty_pages)
+        bits = 0;
+    baseline = saved.number;
+}
+
+// a snapshot other than the last one taken or restored brings back every page
+void Dodgy6502::restore(const Snapshot &saved){
+    if(saved.cpu != this)
+        throw std::runtime_error("Snapshot of another CPU");
+    if(saved.number != baseline)
+        for(auto &bits : dirty_pages)
+            bits = ~0ull;
+
+    a = saved.a;
+    x = saved.x;
+    y = saved.y;
+    sp = saved.sp;
+    set_status(saved.p);
+    pc = saved.pc;
+    cycles = saved.cycles;
+    interrupts = saved.interrupts;
+    events = saved.events;
+    halt = STOP_NONE;
+    memcpy(memory, saved.ram.data(), 2*256);
+
+    unsigned long long dirty[4];
+    memcpy(dirty, dirty_pages, sizeof dirty);
+    for(int page = 2; page < 256; page++){
+        if(!dirty[page >> 6]){
+            page |= 63; // no dirty page in this word
+            continue;
+        }
+        if(!(dirty[page >> 6] >> (page & 63) & 1))
+            continue;
+        if(saved.ram_offsets[page] >= 0)
+            memcpy(ram_pages[page], &saved.ram[saved.ram_offsets[page]], 256);
+        else if(ram_pages[page])
+            memset(ram_pages[page], 0, 256); // allocated since, reads as blank again
+        read_pages[page] = saved.read_pages[page];
+        write_pages[page] = saved.write_pages[page];
+        devices[page] = saved.devices[page];
+        remapped(page, 1);
+    }
+    for(auto &bits : dirty_pages)
+        bits = 0;
+    baseline = saved.number;
+}
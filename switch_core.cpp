@@ -0,0 +1,6 @@
+# include "dispatch.h"
+
+DODGY_FLATTEN Dodgy6502::STOPS6502 Dodgy6502::run_switch(unsigned int until){
+    NoCoverage none;
+    return switch_loop(*this, until, none);
+}
@@ -0,0 +1,73 @@
+# include "6502v2.h"
+# include <cstdio>
+
+// Checks ADC and SBC on every accumulator, operand, carry and D flag against the NMOS
+// algorithm from Bruce Clark's decimal mode tutorial, appendix A and B. The reference is
+// kept deliberately close to the text and shares no code with impl_inst.h.
+
+struct Result {
+    int a;
+    int flags; // N, V, Z and C in their status bits
+};
+
+static Result reference(bool subtract, int a, int value, int carry, bool decimal){
+    int binary = subtract ? a - value - (1 - carry) : a + value + carry;
+    int signed_binary = subtract ? (signed char)a - (signed char)value - (1 - carry)
+                                 : (signed char)a + (signed char)value + carry;
+    int n = (binary >> 7) & 1;
+    int v = signed_binary < -128 || signed_binary > 127;
+    int z = (binary & 0xff) == 0;
+    int c = subtract ? binary >= 0 : binary > 0xff;
+    int result = binary & 0xff;
+    if(decimal && !subtract){
+        int low = (a & 0x0f) + (value & 0x0f) + carry;
+        if(low >= 0x0a)
+            low = ((low + 0x06) & 0x0f) + 0x10;
+        int sum = (a & 0xf0) + (value & 0xf0) + low;
+        int signed_sum = (signed char)(a & 0xf0) + (signed char)(value & 0xf0) + low;
+        n = (signed_sum >> 7) & 1;
+        v = signed_sum < -128 || signed_sum > 127;
+        if(sum >= 0xa0)
+            sum += 0x60;
+        c = sum >= 0x100;
+        result = sum & 0xff;
+    }
+    else if(decimal){
+        int low = (a & 0x0f) - (value & 0x0f) + carry - 1;
+        if(low < 0)
+            low = ((low - 0x06) & 0x0f) - 0x10;
+        int difference = (a & 0xf0) - (value & 0xf0) + low;
+        if(difference < 0)
+            difference -= 0x60;
+        result = difference & 0xff;
+    }
+    return {result, n << 7 | v << 6 | z << 1 | c};
+}
+
+int main(){
+    Dodgy6502 cpu;
+    long failures = 0;
+    for(int subtract = 0; subtract < 2; subtract++)
+    for(int decimal = 0; decimal < 2; decimal++)
+    for(int carry = 0; carry < 2; carry++)
+    for(int a = 0; a < 256; a++)
+    for(int value = 0; value < 256; value++){
+        cpu.set_status((decimal ? Dodgy6502::D : 0) | carry);
+        cpu.a = a;
+        cpu.fetched = value;
+        if(subtract)
+            cpu.SBC();
+        else
+            cpu.ADC();
+        Result expected = reference(subtract, a, value, carry, decimal);
+        int flags = cpu.status() & (Dodgy6502::N | Dodgy6502::V | Dodgy6502::Z | Dodgy6502::C);
+        if(cpu.a != expected.a || flags != expected.flags){
+            if(failures++ < 10)
+                printf("%s D=%d C=%d A=%02x M=%02x: got A=%02x P=%02x, expected A=%02x P=%02x\n",
+                       subtract ? "SBC" : "ADC", decimal, carry, a, value, cpu.a, flags, expected.a, expected.flags);
+        }
+    }
+    if(failures)
+        printf("%ld of 262144 cases failed\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,71 @@
+# include "batch.h"
+# include <algorithm>
+# include <cstdio>
+# include <cstdlib>
+# include <unistd.h>
+
+// Batch jobs patched over the firmware image: each job has to see its own patch, in data
+// and in code, on every engine, and leave the image shared with the other jobs untouched.
+
+static const byte firmware[] = {
+    0xad, 0x00, 0x81, // $8000 LDA $8100
+    0xae, 0x01, 0x81, // $8003 LDX $8101
+    0x00,             // $8006 BRK
+};
+
+int main(){
+    byte image[0x200] = {};
+    std::copy(firmware, firmware + sizeof firmware, image);
+    image[0x100] = 0x11;
+    image[0x101] = 0x22;
+    char filename[] = "/tmp/batch_patchXXXXXX";
+    int fd = mkstemp(filename);
+    if(fd < 0 || write(fd, image, sizeof image) != (ssize_t)sizeof image){
+        perror(filename);
+        return 1;
+    }
+    close(fd);
+    RomFile rom(filename);
+    unlink(filename);
+
+    struct Case {
+        MemoryPatch patch;
+        byte a, x;
+    } cases[] = {
+        {{0x0200, {0x55}}, 0x11, 0x22},             // RAM beside the image
+        {{0x8100, {0x42}}, 0x42, 0x22},             // data, the rest of the page stays
+        {{0x8100, {0x99}}, 0x99, 0x22},
+        {{0x8100, {0x00, 0x00}}, 0x00, 0x00},       // zeros count too
+        {{0x8000, {0xa9, 0x77, 0xea}}, 0x77, 0x22}, // code: LDA #$77; NOP
+    };
+    std::vector<BatchJob> jobs;
+    for(int engine = Dodgy6502::ENGINE_REFERENCE; engine <= Dodgy6502::ENGINE_JIT; engine++){
+        for(const Case &test : cases){
+            BatchJob job;
+            job.rom = &rom;
+            job.rom_base = 0x8000;
+            job.pc = 0x8000;
+            job.budget = 1000;
+            job.engine = (Dodgy6502::ENGINES6502)engine;
+            job.patches.push_back(test.patch);
+            jobs.push_back(job);
+        }
+    }
+    std::vector<BatchResult> results = BatchRunner().run(jobs);
+
+    int failures = 0;
+    for(size_t i = 0; i < results.size(); i++){
+        const Case &test = cases[i % (sizeof cases / sizeof cases[0])];
+        if(results[i].stop != Dodgy6502::STOP_BRK || results[i].a != test.a || results[i].x != test.x){
+            printf("job %zu, engine %d: stop %d a %02x x %02x, expected a %02x x %02x\n", i,
+                   jobs[i].engine, results[i].stop, results[i].a, results[i].x, test.a, test.x);
+            failures++;
+        }
+    }
+    if(rom.data[0] != firmware[0] || rom.data[0x100] != 0x11){
+        printf("a patch reached the shared image\n");
+        failures++;
+    }
+    printf("%d failures\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,204 @@
+# include "6502v2.h"
+# include "opcodes.h"
+# include <cstdio>
+# include <cstring>
+# include <string>
+# include <vector>
+
+// Runs the same programs on every engine and compares registers, cycles, the stop and all
+// of memory with the reference engine. Random memory checks the decoding and the halts,
+// random loop bodies run often enough to get cached, translated and compiled, stores into
+// their own page included. Only runs that halt are compared, the block engines check the
+// budget between blocks and may stop a few instructions later than the reference. Last,
+// pages of the longest blocks the JIT compiles fill its code region a few times over.
+
+struct Random {
+    unsigned long long state;
+    unsigned int next(){
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return (unsigned int)state;
+    }
+    byte next_byte(){ return next() >> 8; }
+};
+
+struct Result {
+    Dodgy6502::STOPS6502 stop;
+    unsigned long long cycles;
+    word pc;
+    byte a, x, y, sp, p;
+    std::vector<byte> memory;
+};
+
+static Result run(const std::vector<byte> &memory, word pc, Dodgy6502::ENGINES6502 engine, unsigned long long budget){
+    Dodgy6502 cpu;
+    cpu.load_memory(memory.data(), 0xffff, 0);
+    cpu.pc = pc;
+    cpu.engine = engine;
+    Result result;
+    result.stop = cpu.run_for(budget);
+    result.cycles = cpu.cycles;
+    result.pc = cpu.pc;
+    result.a = cpu.a;
+    result.x = cpu.x;
+    result.y = cpu.y;
+    result.sp = cpu.sp;
+    result.p = cpu.status();
+    for(unsigned int address = 0; address < 0x10000; address++)
+        result.memory.push_back(cpu.read(address));
+    return result;
+}
+
+static const char* const ENGINE_NAMES[] = {"reference", "switch", "threaded", "cached", "blocks", "jit"};
+
+// every engine against the reference, returns the failures
+static int compare(const char* program, const std::vector<byte> &memory, word pc, unsigned long long budget, int &halted){
+    Result expected = run(memory, pc, Dodgy6502::ENGINE_REFERENCE, budget);
+    if(expected.stop == Dodgy6502::STOP_CYCLES)
+        return 0;
+    halted++;
+    int failures = 0;
+    for(int engine = Dodgy6502::ENGINE_SWITCH; engine <= Dodgy6502::ENGINE_JIT; engine++){
+        Result got = run(memory, pc, (Dodgy6502::ENGINES6502)engine, budget);
+        int address = -1;
+        for(unsigned int i = 0; i < 0x10000 && address < 0; i++)
+            if(got.memory[i] != expected.memory[i])
+                address = i;
+        if(got.stop != expected.stop || got.cycles != expected.cycles || got.pc != expected.pc || got.a != expected.a ||
+           got.x != expected.x || got.y != expected.y || got.sp != expected.sp || got.p != expected.p || address >= 0){
+            if(failures++ < 10)
+                printf("%s, %s: stop %d cycles %llu pc %04x a %02x x %02x y %02x sp %02x p %02x, expected "
+                       "stop %d cycles %llu pc %04x a %02x x %02x y %02x sp %02x p %02x%s\n",
+                       program, ENGINE_NAMES[engine], got.stop, got.cycles, got.pc, got.a, got.x, got.y, got.sp, got.p,
+                       expected.stop, expected.cycles, expected.pc, expected.a, expected.x, expected.y, expected.sp,
+                       expected.p, address >= 0 ? ", memory differs" : "");
+        }
+    }
+    return failures;
+}
+
+// documented instructions that leave pc on the next one, with their length
+struct Straight {
+    byte opcode, length;
+};
+
+static std::vector<Straight> straight_line(){
+    std::vector<Straight> opcodes;
+    const std::string jumps = " BRK JMP JSR RTS RTI ";
+#define STRAIGHT(opc, name, mode, impl, cycles, description) \
+    if(strcmp(#mode, "rel") && strcmp(#mode, "ind") && jumps.find(" " name " ") == std::string::npos) \
+        opcodes.push_back({opc, (byte)(!strcmp(#mode, "imp") ? 1 : #mode[0] == 'a' ? 3 : 2)});
+    DODGY6502_OFFICIAL_OPCODES(STRAIGHT)
+#undef STRAIGHT
+    return opcodes;
+}
+
+// Random memory, running from $0200. Most of it is code the first few instructions jump
+// into, so the runs are short and end on BRK, JAM or an undocumented opcode.
+static std::vector<byte> random_memory(Random &random){
+    std::vector<byte> memory(0x10000);
+    for(byte &value : memory)
+        value = random.next_byte();
+    return memory;
+}
+
+// A loop at $0400 over a random body, counted down in $FF. Zero page operands stay below
+// $80, absolute ones hit the data pages $0200-$03FF and sometimes the loop's own page.
+static std::vector<byte> random_loop(Random &random, const std::vector<Straight> &opcodes){
+    std::vector<byte> memory(0x10000);
+    for(unsigned int address = 0; address < 0x400; address++)
+        memory[address] = address < 0x80 || address >= 0x200 ? random.next_byte() : 0;
+    word pc = 0x400;
+    memory[pc++] = 0xa9; // LDA #20
+    memory[pc++] = 20;
+    memory[pc++] = 0x85; // STA $FF
+    memory[pc++] = 0xff;
+    word loop = pc;
+    for(int count = 10 + random.next() % 40; count--; ){
+        const Straight &op = opcodes[random.next() % opcodes.size()];
+        memory[pc++] = op.opcode;
+        if(op.length == 2)
+            memory[pc++] = random.next_byte() & 0x7f;
+        else if(op.length == 3){
+            word address = random.next() % 8 ? 0x200 + random.next() % 0x200 : 0x400 + random.next() % 0x100;
+            memory[pc++] = address;
+            memory[pc++] = address >> 8;
+        }
+    }
+    memory[pc++] = 0xc6; // DEC $FF
+    memory[pc++] = 0xff;
+    memory[pc++] = 0xf0; // BEQ +3
+    memory[pc++] = 0x03;
+    memory[pc++] = 0x4c; // JMP loop
+    memory[pc++] = loop;
+    memory[pc++] = loop >> 8;
+    memory[pc] = 0x00; // BRK
+    return memory;
+}
+
+// Pages of 32 INC abs, the longest block the JIT compiles, chained by JMP and run x
+// times around. The first `lead_in` of them on the first page are three NOPs instead,
+// which moves where in a block the code region runs full.
+static std::vector<byte> jit_filler(int pages, int lead_in){
+    std::vector<byte> memory(0x10000);
+    for(int page = 0; page < pages; page++){
+        word at = 0x0400 + page * 0x100;
+        for(int i = 0; i < 32; i++){
+            bool nop = !page && i < lead_in;
+            memory[at + 3 * i] = nop ? 0xea : 0xee;
+            memory[at + 3 * i + 1] = nop ? 0xea : 0x00;
+            memory[at + 3 * i + 2] = nop ? 0xea : 0x03;
+        }
+        word next = page + 1 < pages ? at + 0x100 : 0x0200;
+        memory[at + 96] = 0x4c;
+        memory[at + 97] = next;
+        memory[at + 98] = next >> 8;
+    }
+    const byte tail[] = {0xca,            // $0200 DEX
+                         0xd0, 0x01,      // BNE +1
+                         0x00,            // BRK
+                         0x4c, 0x00, 0x04 // JMP $0400
+                        };
+    for(unsigned int i = 0; i < sizeof tail; i++)
+        memory[0x200 + i] = tail[i];
+    return memory;
+}
+
+int main(){
+    int failures = 0, halted = 0, programs = 0;
+    std::vector<Straight> opcodes = straight_line();
+    for(unsigned long long seed = 1; seed <= 500; seed++){
+        Random random{seed * 0x9e3779b97f4a7c15ull};
+        failures += compare("random memory", random_memory(random), 0x200, 100000, halted);
+        failures += compare("random loop", random_loop(random, opcodes), 0x400, 1000000, halted);
+        programs += 2;
+    }
+    if(halted < programs / 2){
+        printf("only %d of %d programs halted\n", halted, programs);
+        failures++;
+    }
+    for(int lead_in = 0; lead_in <= 12; lead_in++){
+        std::vector<byte> memory = jit_filler(230, lead_in);
+        Dodgy6502::ENGINES6502 engines[] = {Dodgy6502::ENGINE_REFERENCE, Dodgy6502::ENGINE_JIT};
+        Result results[2];
+        for(int i = 0; i < 2; i++){
+            Dodgy6502 cpu;
+            cpu.load_memory(memory.data(), 0xffff, 0);
+            cpu.pc = 0x400;
+            cpu.x = 20;
+            cpu.engine = engines[i];
+            results[i].stop = cpu.run();
+            results[i].cycles = cpu.cycles;
+            results[i].a = cpu.read(0x300);
+        }
+        if(results[1].stop != results[0].stop || results[1].cycles != results[0].cycles || results[1].a != results[0].a){
+            printf("jit filler, lead in %d: stop %d cycles %llu $0300 %02x, expected stop %d cycles %llu $0300 %02x\n",
+                   lead_in, results[1].stop, results[1].cycles, results[1].a, results[0].stop, results[0].cycles,
+                   results[0].a);
+            failures++;
+        }
+    }
+    printf("%d of %d programs halted, %d failures\n", halted, programs, failures);
+    return failures != 0;
+}
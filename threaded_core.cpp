@@ -0,0 +1,63 @@
+# include "dispatch.h"
+
+// Direct threaded engine: every handler ends with its own indirect jump to the next
+// handler, so the host branch predictor sees one branch per opcode instead of the
+// single shared one in run_switch(). Needs the GCC/Clang labels-as-values extension.
+#if defined(__GNUC__)
+
+DODGY_FLATTEN Dodgy6502::STOPS6502 Dodgy6502::run_threaded(unsigned int until){
+    // Labels in the order of opcodes.h are constant data. The table indexed by opcode is
+    // sorted from them once, on the first call, so short runs do not pay for it.
+#define THREADED_LABEL(opc, name, mode, impl, cycles, description) &&op_##opc,
+#define THREADED_OPCODE(opc, name, mode, impl, cycles, description) opc,
+    static void* const labels[256] = { DODGY6502_OPCODES(THREADED_LABEL) };
+    static const byte opcodes[256] = { DODGY6502_OPCODES(THREADED_OPCODE) };
+#undef THREADED_LABEL
+#undef THREADED_OPCODE
+    static void* dispatch_table[256];
+    static const bool sorted = []{
+        for(int i = 0; i < 256; i++)
+            dispatch_table[opcodes[i]] = labels[i];
+        return true;
+    }();
+    (void)sorted;
+
+    unsigned long long now = cycles;
+    STOPS6502 stop;
+
+#define DISPATCH() \
+    if(now >= deadline) goto stop_cycles; \
+    if(pc == until) goto stop_pc; \
+    cycles = now; \
+    goto *dispatch_table[read(pc++)]
+    DISPATCH();
+
+#define THREADED_HANDLER(opc, name, mode, impl, cycles, description) \
+    op_##opc: \
+    if(byte taken = execute<&Dodgy6502::mode, &Dodgy6502::impl, cycles>(*this)){ \
+        now += taken; \
+        DISPATCH(); \
+    } \
+    stop = stop_reason(opc); \
+    goto done;
+    DODGY6502_OPCODES(THREADED_HANDLER)
+#undef THREADED_HANDLER
+#undef DISPATCH
+
+stop_pc:
+    stop = STOP_PC;
+    goto done;
+stop_cycles:
+    stop = STOP_CYCLES;
+done:
+    cycles = now;
+    return stop;
+}
+
+#else
+
+Dodgy6502::STOPS6502 Dodgy6502::run_threaded(unsigned int until){
+    return run_switch(until);
+}
+
+#endif
@@ -0,0 +1,352 @@
+# include "via.h"
+
+// The registers are read and written at the cycle the accessing instruction started, the
+// engines publish it in Dodgy6502::cycles. Timer 1 is kept as the count it had at t1_base
+// and always reloads its latch after showing 0xffff for a cycle, in one shot mode only the
+// interrupt is one shot. Timer 2 keeps counting down without reloading. Events are only
+// scheduled for underflows that set a flag or toggle PB7, polling a timer costs a read.
+// The shift register completes 8 shifts in one event when clocked internally, a byte
+// shifted in takes the level of CB2. The CA2 and CB2 output modes are not modelled.
+
+Via6522::Via6522(Dodgy6502 &cpu, unsigned int irq_source) : cpu(cpu), irq_source(irq_source){
+    reset();
+}
+
+Via6522::~Via6522(){
+    cpu.cancel(this, T1_EVENT);
+    cpu.cancel(this, T2_EVENT);
+    cpu.cancel(this, SR_EVENT);
+    if(irq_out)
+        cpu.irq(false, irq_source);
+}
+
+void Via6522::reset(){
+    ora = orb = ddra = ddrb = ira_latch = irb_latch = 0;
+    acr = pcr = ifr = ier = 0;
+    t1_base = t2_base = cpu.cycles;
+    t1_start = t1_latch = t2_start = 0xffff;
+    t2_latch_low = 0xff;
+    t1_armed = t2_armed = pb7 = false;
+    sr = 0;
+    sr_bits = 0;
+    cpu.cancel(this, T1_EVENT);
+    cpu.cancel(this, T2_EVENT);
+    cpu.cancel(this, SR_EVENT);
+    update_irq();
+}
+
+word Via6522::t1_counter() const{
+    unsigned long long now = cpu.cycles;
+    if(now < t1_base)
+        return 0xffff; // the cycle in front of a reload
+    unsigned long long elapsed = now - t1_base;
+    if(elapsed <= t1_start)
+        return t1_start - elapsed;
+    unsigned long long phase = (elapsed - t1_start - 1) % (t1_latch + 2u);
+    return phase == 0 ? 0xffff : t1_latch - (phase - 1);
+}
+
+// the count in progress keeps running, only reloads after this one use the new latch
+void Via6522::t1_set_latch(word latch){
+    unsigned long long now = cpu.cycles;
+    if(now >= t1_base){
+        unsigned long long elapsed = now - t1_base;
+        if(elapsed <= t1_start){
+            t1_start -= elapsed;
+            t1_base = now;
+        }
+        else{
+            unsigned long long phase = (elapsed - t1_start - 1) % (t1_latch + 2u);
+            if(phase == 0)
+                t1_base = now + 1;
+            else{
+                t1_start = t1_latch - (phase - 1);
+                t1_base = now;
+            }
+        }
+    }
+    t1_latch = latch;
+    if(now < t1_base)
+        t1_start = latch;
+}
+
+void Via6522::t1_load(word value){
+    t1_start = value;
+    t1_base = cpu.cycles;
+    t1_armed = true;
+    if(acr & 0x80)
+        pb7 = false;
+    clear_flags(IRQ_T1);
+    t1_schedule();
+}
+
+// the next cycle the counter rolls over to 0xffff
+void Via6522::t1_schedule(){
+    if(!t1_armed && (acr & 0xc0) != 0xc0){
+        cpu.cancel(this, T1_EVENT);
+        return;
+    }
+    unsigned long long now = cpu.cycles, period = t1_latch + 2u;
+    unsigned long long at = t1_base + t1_start + 1;
+    if(at <= now)
+        at += ((now - at) / period + 1) * period;
+    cpu.schedule(at, this, T1_EVENT);
+}
+
+word Via6522::t2_counter() const{
+    if(t2_counts_pulses())
+        return t2_start;
+    return t2_start - (word)(cpu.cycles - t2_base);
+}
+
+void Via6522::pb6_pulse(){
+    if(!t2_counts_pulses())
+        return;
+    if(--t2_start == 0 && t2_armed){
+        t2_armed = false;
+        set_flags(IRQ_T2);
+    }
+}
+
+void Via6522::sr_start(){
+    clear_flags(IRQ_SR);
+    cpu.cancel(this, SR_EVENT);
+    sr_bits = 0;
+    int mode = sr_mode();
+    if(mode == 0 || mode == 4) // disabled or shifting out forever without an interrupt
+        return;
+    sr_bits = 8;
+    if(mode == 3 || mode == 7) // clocked by CB1
+        return;
+    unsigned long long bit = mode == 2 || mode == 6 ? 2 : 2 * (t2_latch_low + 2u);
+    cpu.schedule(cpu.cycles + 8 * bit, this, SR_EVENT);
+}
+
+void Via6522::sr_shift(){
+    if(sr_mode() == 3)
+        sr = (sr << 1) | cb2_level;
+    else
+        sr = (sr << 1) | (sr >> 7);
+    if(--sr_bits == 0)
+        set_flags(IRQ_SR);
+}
+
+// shifting out 8 bits leaves the register as it was
+void Via6522::sr_done(){
+    if(sr_mode() < 4)
+        sr = cb2_level ? 0xff : 0x00;
+    sr_bits = 0;
+    set_flags(IRQ_SR);
+}
+
+void Via6522::event(Dodgy6502 &, int id){
+    switch(id){
+        case T1_EVENT:
+            if(t1_armed)
+                set_flags(IRQ_T1);
+            if(acr & 0x40){
+                if(acr & 0x80)
+                    pb7 = !pb7;
+            }
+            else{
+                if(t1_armed && (acr & 0x80))
+                    pb7 = true;
+                t1_armed = false;
+            }
+            t1_schedule();
+            break;
+        case T2_EVENT:
+            if(t2_armed && !t2_counts_pulses()){
+                t2_armed = false;
+                set_flags(IRQ_T2);
+            }
+            break;
+        case SR_EVENT:
+            if(sr_bits)
+                sr_done();
+            break;
+    }
+}
+
+byte Via6522::read(word address){
+    switch(address & 0xf){
+        case ORB: {
+            clear_cb();
+            byte pins = acr & 0x02 ? irb_latch : port_b_in;
+            byte value = (orb & ddrb) | (pins & ~ddrb);
+            return acr & 0x80 ? (value & 0x7f) | (pb7 << 7) : value;
+        }
+        case ORA:
+            clear_ca();
+            return acr & 0x01 ? ira_latch : port_a();
+        case ORA_NH:
+            return acr & 0x01 ? ira_latch : port_a();
+        case DDRB: return ddrb;
+        case DDRA: return ddra;
+        case T1CL:
+            clear_flags(IRQ_T1);
+            return t1_counter();
+        case T1CH: return t1_counter() >> 8;
+        case T1LL: return t1_latch;
+        case T1LH: return t1_latch >> 8;
+        case T2CL:
+            clear_flags(IRQ_T2);
+            return t2_counter();
+        case T2CH: return t2_counter() >> 8;
+        case SR: {
+            byte value = sr;
+            sr_start();
+            return value;
+        }
+        case ACR: return acr;
+        case PCR: return pcr;
+        case IFR: return ifr | (ifr & ier & 0x7f ? IRQ_ANY : 0);
+        default: return ier | 0x80;
+    }
+}
+
+void Via6522::write(word address, byte data){
+    switch(address & 0xf){
+        case ORB:
+            orb = data;
+            clear_cb();
+            break;
+        case ORA:
+            ora = data;
+            clear_ca();
+            break;
+        case ORA_NH: ora = data; break;
+        case DDRB: ddrb = data; break;
+        case DDRA: ddra = data; break;
+        case T1CL:
+        case T1LL:
+            t1_set_latch((t1_latch & 0xff00) | data);
+            t1_schedule();
+            break;
+        case T1CH:
+            t1_set_latch((data << 8) | (t1_latch & 0xff));
+            t1_load(t1_latch);
+            break;
+        case T1LH:
+            t1_set_latch((data << 8) | (t1_latch & 0xff));
+            clear_flags(IRQ_T1);
+            t1_schedule();
+            break;
+        case T2CL: t2_latch_low = data; break;
+        case T2CH:
+            t2_start = (data << 8) | t2_latch_low;
+            t2_base = cpu.cycles;
+            t2_armed = true;
+            clear_flags(IRQ_T2);
+            if(t2_counts_pulses())
+                cpu.cancel(this, T2_EVENT);
+            else
+                cpu.schedule(t2_base + t2_start + 1, this, T2_EVENT);
+            break;
+        case SR:
+            sr = data;
+            sr_start();
+            break;
+        case ACR: {
+            bool counted_pulses = t2_counts_pulses();
+            word t2 = t2_counter();
+            acr = data;
+            if(counted_pulses != t2_counts_pulses()){
+                t2_start = t2;
+                t2_base = cpu.cycles;
+                if(t2_counts_pulses() || !t2_armed)
+                    cpu.cancel(this, T2_EVENT);
+                else
+                    cpu.schedule(t2_base + t2_start + 1, this, T2_EVENT);
+            }
+            t1_schedule();
+            if(sr_mode() == 0 || sr_mode() == 4){
+                sr_bits = 0;
+                cpu.cancel(this, SR_EVENT);
+            }
+            break;
+        }
+        case PCR: pcr = data; break;
+        case IFR: clear_flags(data & 0x7f); break;
+        default:
+            if(data & 0x80)
+                ier |= data & 0x7f;
+            else
+                ier &= ~data;
+            update_irq();
+    }
+}
+
+byte Via6522::port_a() const{
+    return (ora & ddra) | (port_a_in & ~ddra);
+}
+
+byte Via6522::port_b() const{
+    byte value = (orb & ddrb) | (port_b_in & ~ddrb);
+    return acr & 0x80 ? (value & 0x7f) | (pb7 << 7) : value;
+}
+
+bool Via6522::active_edge(bool old_level, bool level, bool positive) const{
+    return old_level != level && level == positive;
+}
+
+void Via6522::ca1(bool level){
+    if(active_edge(ca1_level, level, pcr & 0x01)){
+        if(acr & 0x01)
+            ira_latch = port_a();
+        set_flags(IRQ_CA1);
+    }
+    ca1_level = level;
+}
+
+// CA2 and CB2 only interrupt in the input modes of the PCR
+void Via6522::ca2(bool level){
+    if(!(pcr & 0x08) && active_edge(ca2_level, level, pcr & 0x04))
+        set_flags(IRQ_CA2);
+    ca2_level = level;
+}
+
+void Via6522::cb1(bool level){
+    if(active_edge(cb1_level, level, pcr & 0x10)){
+        if(acr & 0x02)
+            irb_latch = port_b();
+        set_flags(IRQ_CB1);
+    }
+    if(level && !cb1_level && sr_bits && (sr_mode() == 3 || sr_mode() == 7))
+        sr_shift();
+    cb1_level = level;
+}
+
+void Via6522::cb2(bool level){
+    if(!(pcr & 0x80) && active_edge(cb2_level, level, pcr & 0x40))
+        set_flags(IRQ_CB2);
+    cb2_level = level;
+}
+
+// reading or writing a port clears its control line flags, CA2 and CB2 not in the
+// independent interrupt modes
+void Via6522::clear_ca(){
+    clear_flags((pcr & 0x0a) == 0x02 ? IRQ_CA1 : IRQ_CA1 | IRQ_CA2);
+}
+
+void Via6522::clear_cb(){
+    clear_flags((pcr & 0xa0) == 0x20 ? IRQ_CB1 : IRQ_CB1 | IRQ_CB2);
+}
+
+void Via6522::set_flags(byte flags){
+    ifr |= flags;
+    update_irq();
+}
+
+void Via6522::clear_flags(byte flags){
+    ifr &= ~flags;
+    update_irq();
+}
+
+void Via6522::update_irq(){
+    bool level = ifr & ier & 0x7f;
+    if(level != irq_out){
+        irq_out = level;
+        cpu.irq(level, irq_source);
+    }
+}
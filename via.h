@@ -0,0 +1,83 @@
+#pragma once
+#include "6502v2.h"
+
+// MOS 6522 versatile interface adapter, see via.cpp. Map it with Dodgy6502::map_device(),
+// the 16 registers repeat over the page. The timers are never ticked: they keep the cycle
+// they were loaded at and derive their value from Dodgy6502::cycles when read, underflows
+// that raise an interrupt flag are scheduled as events. The IRQ output drives the CPU's
+// IRQ line through `irq_source`.
+class Via6522 : public BusDevice, public TimedDevice {
+public:
+    explicit Via6522(Dodgy6502 &cpu, unsigned int irq_source = 1);
+    ~Via6522() override;
+    void reset();
+
+    byte read(word address) override;
+    void write(word address, byte data) override;
+    void event(Dodgy6502 &cpu, int id) override;
+
+    // input pins, the control lines interrupt on the edge selected in the PCR
+    byte port_a_in = 0xff;
+    byte port_b_in = 0xff;
+    void ca1(bool level);
+    void ca2(bool level);
+    void cb1(bool level); // also clocks the shift register in the external clock modes
+    void cb2(bool level); // also the shift register input
+    void pb6_pulse(); // counted by timer 2 in pulse counting mode
+
+    // levels on the port pins, inputs where the data direction register is 0
+    byte port_a() const;
+    byte port_b() const;
+
+    enum REGISTERS6522{
+        ORB, ORA, DDRB, DDRA, T1CL, T1CH, T1LL, T1LH, T2CL, T2CH, SR, ACR, PCR, IFR, IER, ORA_NH
+    };
+    enum IRQS6522{
+        IRQ_CA2 = (1 << 0), IRQ_CA1 = (1 << 1), IRQ_SR = (1 << 2), IRQ_CB2 = (1 << 3),
+        IRQ_CB1 = (1 << 4), IRQ_T2 = (1 << 5), IRQ_T1 = (1 << 6), IRQ_ANY = (1 << 7),
+    };
+
+private:
+    enum { T1_EVENT, T2_EVENT, SR_EVENT };
+    Dodgy6502 &cpu;
+    unsigned int irq_source;
+    bool irq_out = false;
+
+    byte ora = 0, orb = 0, ddra = 0, ddrb = 0, ira_latch = 0, irb_latch = 0;
+    byte acr = 0, pcr = 0, ifr = 0, ier = 0;
+    bool ca1_level = true, ca2_level = true, cb1_level = true, cb2_level = true;
+
+    // timer 1 counts down from t1_start at cycle t1_base, then shows 0xffff for a cycle
+    // and reloads the latch, see t1_counter()
+    unsigned long long t1_base = 0;
+    word t1_start = 0xffff, t1_latch = 0xffff;
+    bool t1_armed = false; // the next underflow sets IRQ_T1
+    bool pb7 = false; // toggled on every underflow when the ACR routes timer 1 to PB7
+    word t1_counter() const;
+    void t1_load(word value);
+    void t1_set_latch(word latch);
+    void t1_schedule();
+
+    // timer 2 counts down from t2_start at cycle t2_base without reloading, in pulse
+    // counting mode t2_start is the counter itself
+    unsigned long long t2_base = 0;
+    word t2_start = 0xffff;
+    byte t2_latch_low = 0xff;
+    bool t2_armed = false;
+    bool t2_counts_pulses() const { return acr & 0x20; }
+    word t2_counter() const;
+
+    byte sr = 0;
+    int sr_bits = 0; // bits left to shift, 0 when idle
+    int sr_mode() const { return (acr >> 2) & 7; }
+    void sr_start();
+    void sr_shift(); // one bit in the external clock modes
+    void sr_done();
+
+    bool active_edge(bool old_level, bool level, bool positive) const;
+    void clear_ca();
+    void clear_cb();
+    void set_flags(byte flags);
+    void clear_flags(byte flags);
+    void update_irq();
+};